@@ -44,6 +44,7 @@
   */
 
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
 #include "stm32_spi_sd.h"
 #include "systick.h"
 
@@ -62,6 +63,26 @@
 static DSTATUS Stat = STA_NOINIT;	/* Disk status */
 
 static BYTE CardType;		/* b0:MMC, b1:SDv1, b2:SDv2, b3:Block addressing */
+
+/*   :    CMD18  ,
+ *     DMA,    flash.
+ * DMA  ,   :    ,
+ *  0xFF,         .
+ *      stream_take() */
+static struct {
+    DWORD sector;		/* ,   ( )  ahead */
+    BYTE open;			/*  CMD18, CS  */
+    BYTE busy;			/*    DMA */
+    uint32_t start;		/*     DMA */
+    uint32_t xfer;		/*      */
+} stream;
+
+#define AHEAD_SIZE	(1 + SD_BLOCK_SIZE + 2)	/*  +  + CRC */
+#define TAIL_PIO	8	/*   -  DMA */
+
+static uint8_t ahead[2 * AHEAD_SIZE];	/*      */
+static uint8_t dummy = SD_DUMMY_BYTE;	/*  : DMA    flash    */
+static SD_Stat stat;
 static void deselect(void);
 static int select(void);
 static int wait_ready(void);
@@ -77,6 +98,10 @@ static void SD_SPI_Init(void);
 static int rcvr_datablock(BYTE *, UINT);
 static int xmit_datablock(const uint8_t * buff, uint8_t token);
 static BYTE send_cmd(BYTE cmd, DWORD);
+static int rcvr_token(void);
+static void stream_next(void);
+static int stream_take(BYTE *);
+static void stream_stop(void);
 
 /*-----------------------------------------------------------------------*/
 /* Receive bytes from the card (bitbanging)                              */
@@ -243,16 +268,8 @@ static int rcvr_datablock(	/* 1:OK, 0:Failed */
     )
 {
     BYTE d[2];
-    UINT tmr;
-
 
-    for (tmr = 1000; tmr; tmr--) {	/* Wait for data packet in timeout of 100ms */
-	rcvr_mmc(d, 1);
-	if (d[0] != 0xFF)
-	    break;
-	dly_us(100);
-    }
-    if (d[0] != 0xFE)
+    if (!rcvr_token())
 	return 0;		/* If not valid data token, return with error */
 
     rcvr_mmc(buff, btr);	/* Receive the data block into buffer */
@@ -263,6 +280,23 @@ static int rcvr_datablock(	/* 1:OK, 0:Failed */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Wait for the data token in timeout of 100ms                           */
+/*-----------------------------------------------------------------------*/
+static int rcvr_token(void)
+{				/* 1:OK, 0:Timeout or error token */
+    BYTE d;
+
+    set_timeout(100);
+    do {
+	rcvr_mmc(&d, 1);
+    } while (d == 0xFF && !is_timeout());
+
+    return (d == 0xFE) ? 1 : 0;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Send a data packet to the card                                        */
 /*-----------------------------------------------------------------------*/
@@ -357,10 +391,13 @@ static BYTE send_cmd(		/* Returns command response (bit7==1:Send failed) */
 	    return n;
     }
 
-    /* Select the card and wait for ready */
-    deselect();
-    if (!select())
-	return 0xFF;
+    /* Select the card and wait for ready. CMD12 goes in the middle of
+     * a read stream, the card is busy sending data - don't wait for it */
+    if (Cmd != SD_CMD_STOP_TRANSMISSION) {
+	deselect();
+	if (!select())
+	    return 0xFF;
+    }
 
 
     Frame[0] = (Cmd | 0x40);	/*!< Construct byte 1 */
@@ -440,6 +477,140 @@ static uint8_t SD_ReadByte(void)
     return Data;
 }
 
+/*-----------------------------------------------------------------------*/
+/* Receive bc bytes by DMA. TX stream clocks out dummy 0xFF bytes        */
+/*-----------------------------------------------------------------------*/
+static void dma_rcvr_start(uint8_t * buff, uint32_t bc)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(SD_SPI_DMA_RX_STREAM);
+    DMA_DeInit(SD_SPI_DMA_TX_STREAM);
+
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_Channel = SD_SPI_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) & SD_SPI->DR;
+    DMA_InitStructure.DMA_BufferSize = bc;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t) buff;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_Init(SD_SPI_DMA_RX_STREAM, &DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t) & dummy;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+    DMA_Init(SD_SPI_DMA_TX_STREAM, &DMA_InitStructure);
+
+    SPI_I2S_ReceiveData(SD_SPI);	/* Drop a stale byte, if any */
+
+    DMA_Cmd(SD_SPI_DMA_RX_STREAM, ENABLE);
+    DMA_Cmd(SD_SPI_DMA_TX_STREAM, ENABLE);
+    SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+/*-----------------------------------------------------------------------*/
+/* Wait for the end of DMA reception                                     */
+/*-----------------------------------------------------------------------*/
+static void dma_rcvr_wait(void)
+{
+    while (DMA_GetFlagStatus(SD_SPI_DMA_RX_STREAM, SD_SPI_DMA_RX_FLAG_TC) == RESET) {
+    }
+
+    SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+    DMA_Cmd(SD_SPI_DMA_RX_STREAM, DISABLE);
+    DMA_Cmd(SD_SPI_DMA_TX_STREAM, DISABLE);
+    DMA_ClearFlag(SD_SPI_DMA_RX_STREAM, SD_SPI_DMA_RX_FLAGS);
+    DMA_ClearFlag(SD_SPI_DMA_TX_STREAM, SD_SPI_DMA_TX_FLAGS);
+}
+
+/*-----------------------------------------------------------------------*/
+/* Start receiving the next block of an open CMD18 stream                */
+/*-----------------------------------------------------------------------*/
+static void stream_next(void)
+{
+    stream.start = get_cycles();
+    stream.busy = 1;
+    dma_rcvr_start(ahead, AHEAD_SIZE);	/* Gap + token + data + CRC */
+}
+
+/*-----------------------------------------------------------------------*/
+/* Take the block that is being received into ahead                      */
+/*-----------------------------------------------------------------------*/
+static int stream_take(BYTE * buff)
+{				/* 1:OK, 0:Error token or timeout */
+    uint32_t enter, done, p;
+
+    enter = get_cycles();
+    if (DMA_GetFlagStatus(SD_SPI_DMA_RX_STREAM, SD_SPI_DMA_RX_FLAG_TC) == SET) {
+	/* Block arrived while the caller was busy */
+	stat.Hits++;
+	stat.CyclesOverlap += (enter - stream.start < stream.xfer) ? enter - stream.start : stream.xfer;
+	dma_rcvr_wait();
+    } else {
+	dma_rcvr_wait();
+	done = get_cycles();
+	stream.xfer = done - stream.start;
+	stat.CyclesOverlap += enter - stream.start;
+	stat.CyclesWait += done - enter;
+    }
+    stream.busy = 0;
+
+    /* Where the token is: 0xFF before it came while the card was busy */
+    for (p = 0; p < AHEAD_SIZE && ahead[p] == 0xFF; p++);
+
+    if (p == AHEAD_SIZE) {
+	/* Not even started: wait for the token, then the whole block */
+	stat.Late++;
+	if (!rcvr_token())
+	    return 0;
+	p = 0;
+	dma_rcvr_start(ahead + 1, AHEAD_SIZE - 1);
+	dma_rcvr_wait();
+    } else if (ahead[p] != 0xFE) {
+	return 0;		/* Error token */
+    } else if (p > TAIL_PIO) {
+	dma_rcvr_start(ahead + AHEAD_SIZE, p);	/* The tail that didn't fit */
+	dma_rcvr_wait();
+    } else if (p > 0) {
+	rcvr_mmc(ahead + AHEAD_SIZE, p);
+    }
+    stat.Blocks++;
+
+    memcpy(buff, ahead + p + 1, SD_BLOCK_SIZE);
+    return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Close the read stream: finish DMA, send STOP_TRANSMISSION             */
+/*-----------------------------------------------------------------------*/
+static void stream_stop(void)
+{
+    if (!stream.open)
+	return;
+
+    if (stream.busy) {
+	dma_rcvr_wait();
+	stream.busy = 0;
+    }
+    send_cmd(SD_CMD_STOP_TRANSMISSION, 0);
+    deselect();
+    stream.open = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Read-ahead statistics                                                 */
+/*-----------------------------------------------------------------------*/
+const SD_Stat *SD_GetStat(void)
+{
+    return &stat;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Get Disk Status                                                       */
 /*-----------------------------------------------------------------------*/
@@ -449,6 +620,11 @@ DSTATUS disk_status(BYTE drv)
     DSTATUS s = Stat;
     BYTE ocr[4];
 
+    /* FatFs asks before every f_read()/f_lseek()/f_forward(). While a read
+     * stream is open the card in the socket is surely initialized, and CMD58
+     * would close it */
+    if (stream.open && !drv && INS)
+	return Stat;
 
     if (drv || !INS) {
 	s = STA_NODISK | STA_NOINIT;
@@ -480,7 +656,11 @@ DSTATUS disk_initialize(BYTE drv)
     DSTATUS s;
 
 
+    stream_stop();
     SD_SPI_Init();
+    RCC_AHB1PeriphClockCmd(SD_SPI_DMA_CLK, ENABLE);
+
+    cycles_init();		/* For the read-ahead statistics */
 
 
     s = disk_status(drv);	/* Check if card is in the socket */
@@ -568,32 +748,66 @@ DRESULT disk_read(BYTE drv,	/* Physical drive nmuber (0) */
 		  BYTE count	/* Sector count (1..128) */
     )
 {
-    DSTATUS s;
+    UINT bf;
 
+    return disk_read_forward(drv, buff, sector, count, 0, &bf);
+}
 
-    s = disk_status(drv);
-    if (s & STA_NOINIT)
+
+
+/*-----------------------------------------------------------------------*/
+/* Read Sector(s) and hand each one to func as it arrives                */
+/*-----------------------------------------------------------------------*/
+/* Blocks land in buff one after another. func gets each block while
+   the next one is already being received by DMA, so the caller's work
+   overlaps the card as with single-block reads, but with one call per
+   buff. func(0, 0) == 0 stops the read, as in f_forward() */
+DRESULT disk_read_forward(BYTE drv,	/* Physical drive nmuber (0) */
+			  BYTE * buff,	/* Pointer to the data buffer */
+			  DWORD sector,	/* Start sector number (LBA) */
+			  UINT count,	/* Sector count */
+			  UINT(*func) (const BYTE *, UINT),	/* Data sink, 0 - none */
+			  UINT * bf	/* Bytes forwarded */
+    )
+{
+    *bf = 0;
+    /* No CMD58 check here: it would break the open read stream */
+    if (drv || (Stat & STA_NOINIT))
 	return RES_NOTRDY;
     if (!count)
 	return RES_PARERR;
-    if (!(CardType & CT_BLOCK))
-	sector *= 512;		/* Convert LBA to byte address if needed */
+    stat.Reads++;
 
-    if (count == 1) {		/* Single block read */
-	if ((send_cmd(SD_CMD_READ_SINGLE_BLOCK, sector) == 0)	/* READ_SINGLE_BLOCK */
-	    &&rcvr_datablock(buff, 512))
-	    count = 0;
-    } else {			/* Multiple block read */
-	if (send_cmd(SD_CMD_READ_MULT_BLOCK, sector) == 0) {	/* READ_MULTIPLE_BLOCK */
-	    do {
-		if (!rcvr_datablock(buff, 512))
-		    break;
-		buff += 512;
-	    } while (--count);
-	    send_cmd(SD_CMD_STOP_TRANSMISSION, 0);	/* STOP_TRANSMISSION */
+    do {
+	if (func && *bf && !func(0, 0))
+	    return RES_OK;	/* Sink is full */
+
+	if (!stream.open || stream.sector != sector) {
+	    /* Not the next block of the stream - open a new one */
+	    stream_stop();
+	    if (send_cmd(SD_CMD_READ_MULT_BLOCK, (CardType & CT_BLOCK) ? sector : sector * 512) != 0) {	/* READ_MULTIPLE_BLOCK */
+		deselect();
+		break;
+	    }
+	    stream.open = 1;
+	    stat.Streams++;
+	    stream_next();
 	}
-    }
-    deselect();
+
+	if (!stream_take(buff)) {
+	    stream_stop();
+	    break;
+	}
+	sector++;
+
+	/* The next block goes by DMA while the caller processes this one */
+	stream.sector = sector;
+	stream_next();
+	if (func)
+	    func(buff, 512);
+	buff += 512;
+	*bf += 512;
+    } while (--count);
 
     return count ? RES_ERROR : RES_OK;
 }
@@ -612,6 +826,7 @@ DRESULT disk_write(BYTE drv,	/* Physical drive nmuber (0) */
     DSTATUS s;
 
 
+    stream_stop();
     s = disk_status(drv);
     if (s & STA_NOINIT)
 	return RES_NOTRDY;
@@ -659,6 +874,18 @@ DRESULT disk_ioctl(BYTE drv,	/* Physical drive nmuber (0) */
     WORD cs;
 
 
+    if (ctrl == CTRL_POWER) {	/* Only power off: release SPI and DMA */
+	if (buff == 0 || *(BYTE *) buff != 0)
+	    return RES_PARERR;
+	stream_stop();
+	SD_SPI_DeInit();
+	DMA_DeInit(SD_SPI_DMA_RX_STREAM);
+	DMA_DeInit(SD_SPI_DMA_TX_STREAM);
+	Stat |= STA_NOINIT;
+	return RES_OK;
+    }
+
+    stream_stop();		/* The commands below need the bus */
     if (disk_status(drv) & STA_NOINIT)	/* Check if card is in the socket */
 	return RES_NOTRDY;
 
@@ -150,6 +150,20 @@ typedef struct
   uint32_t CardBlockSize; /*!< Card Block Size */
 } SD_CardInfo;
 
+/** 
+  * @brief  Read-ahead statistics (CMD18 stream, next block received by DMA)
+  */
+typedef struct
+{
+  uint32_t Reads;         /*!< disk_read() calls */
+  uint32_t Blocks;        /*!< Blocks delivered to the caller */
+  uint32_t Hits;          /*!< Blocks already on the way when requested */
+  uint32_t Streams;       /*!< CMD18 commands issued */
+  uint32_t CyclesOverlap; /*!< CPU cycles DMA ran while the caller worked */
+  uint32_t CyclesWait;    /*!< CPU cycles spent waiting for DMA */
+  uint32_t Late;          /*!< Blocks whose token came after the DMA ended */
+} SD_Stat;
+
 /**
   * @}
   */
@@ -260,6 +274,18 @@ typedef struct
 #define SD_DETECT_GPIO_PORT              GPIOD                       /* GPIOD */
 #define SD_DETECT_GPIO_CLK               RCC_APB2Periph_GPIOD
 
+
+/**
+  * @brief  SD SPI DMA (SPI1_RX: DMA2 Stream0, SPI1_TX: DMA2 Stream3)
+  */
+#define SD_SPI_DMA_CLK                   RCC_AHB1Periph_DMA2
+#define SD_SPI_DMA_CHANNEL               DMA_Channel_3
+#define SD_SPI_DMA_RX_STREAM             DMA2_Stream0
+#define SD_SPI_DMA_RX_FLAG_TC            DMA_FLAG_TCIF0
+#define SD_SPI_DMA_RX_FLAGS              (DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+#define SD_SPI_DMA_TX_STREAM             DMA2_Stream3
+#define SD_SPI_DMA_TX_FLAGS              (DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+
   
 /** @defgroup STM32_EVAL_SPI_SD_Exported_Macros
   * @{
@@ -278,10 +304,12 @@ typedef struct
 
 DSTATUS disk_status (BYTE);	
 DSTATUS disk_initialize (BYTE);	
-DRESULT disk_read (BYTE,BYTE*,DWORD,BYTE);
+DRESULT disk_read (BYTE,BYTE*,DWORD,BYTE);
+DRESULT disk_read_forward (BYTE,BYTE*,DWORD,UINT,UINT(*)(const BYTE*,UINT),UINT*);
 DRESULT disk_write (BYTE,const BYTE *,DWORD,BYTE);
 DRESULT disk_ioctl (BYTE ,BYTE,void *);
 DWORD   get_fattime (void);
+const SD_Stat *SD_GetStat (void);
 
 
 
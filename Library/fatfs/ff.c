@@ -118,6 +118,12 @@
 #endif
 
 
+/* Number of sector windows */
+#if _FS_WINS < 1 || _FS_WINS > 16
+#error Wrong number of windows (_FS_WINS).
+#endif
+
+
 /* Reentrancy related */
 #if _FS_REENTRANT
 #if _USE_LFN == 1
@@ -715,6 +721,79 @@ void clear_lock (	/* Clear lock entries of the volume */
 /* Change window offset                                                  */
 /*-----------------------------------------------------------------------*/
 
+#if _FS_WINS > 1
+static
+void init_windows (
+	FATFS *fs		/* File system object */
+)
+{
+	BYTE i;
+
+
+	for (i = 0; i < _FS_WINS - 1; i++) {	/* Empty cache, LRU order 0,1,2... */
+		fs->wsects[i] = 0;
+		fs->wdirty[i] = 0;
+		fs->wlru[i] = i;
+	}
+	fs->whits = fs->wmisses = 0;
+}
+
+
+static
+void swap_window (	/* Exchange win[] with a cache window */
+	FATFS *fs,		/* File system object */
+	BYTE i			/* Cache window */
+)
+{
+	DWORD *p = (DWORD*)fs->win, *q = (DWORD*)fs->wbuf[i], d;
+	UINT n;
+
+
+	for (n = SS(fs) / 4; n; n--) {
+		d = *p; *p++ = *q; *q++ = d;
+	}
+	d = fs->winsect; fs->winsect = fs->wsects[i]; fs->wsects[i] = d;
+	n = fs->wflag; fs->wflag = fs->wdirty[i]; fs->wdirty[i] = (BYTE)n;
+}
+
+
+static
+void touch_window (	/* Move a cache window to the head of the LRU list */
+	FATFS *fs,		/* File system object */
+	BYTE n			/* Position in the list */
+)
+{
+	BYTE i = fs->wlru[n];
+
+
+	for (; n; n--) fs->wlru[n] = fs->wlru[n - 1];
+	fs->wlru[0] = i;
+}
+#endif
+
+
+#if !_FS_READONLY
+static
+FRESULT write_window (	/* Write a sector window back */
+	FATFS *fs,		/* File system object */
+	const BYTE *buf,	/* Window buffer */
+	DWORD wsect		/* Sector in it */
+)
+{
+	if (disk_write(fs->drv, buf, wsect, 1) != RES_OK)
+		return FR_DISK_ERR;
+	if (wsect < (fs->fatbase + fs->fsize)) {	/* In FAT area */
+		BYTE nf;
+		for (nf = fs->n_fats; nf > 1; nf--) {	/* Reflect the change to all FAT copies */
+			wsect += fs->fsize;
+			disk_write(fs->drv, buf, wsect, 1);
+		}
+	}
+	return FR_OK;
+}
+#endif
+
+
 static
 FRESULT move_window (
 	FATFS *fs,		/* File system object */
@@ -722,22 +801,55 @@ FRESULT move_window (
 )					/* Move to zero only writes back dirty window */
 {
 	DWORD wsect;
+#if _FS_WINS > 1
+	BYTE i, n;
+#endif
 
 
 	wsect = fs->winsect;
 	if (wsect != sector) {	/* Changed current window */
+#if _FS_WINS > 1
+		for (i = 0; i < _FS_WINS - 1; i++) {
+			if (wsect && fs->wsects[i] == wsect) {	/* Older copy of a sector set to win[] directly */
+				fs->wsects[i] = 0;
+				fs->wdirty[i] = 0;
+			}
+		}
+		if (sector) {
+			for (n = 0; n < _FS_WINS - 1 && fs->wsects[fs->wlru[n]] != sector; n++) ;
+			if (n < _FS_WINS - 1) {		/* Cache hit: swap it with win[] */
+				fs->whits++;
+				swap_window(fs, fs->wlru[n]);
+				touch_window(fs, n);
+				return FR_OK;
+			}
+			fs->wmisses++;
+			if (wsect) {				/* Cache miss: win[] replaces the LRU window */
+				n = _FS_WINS - 2;
+				i = fs->wlru[n];
+#if !_FS_READONLY
+				if (fs->wdirty[i]) {
+					if (write_window(fs, fs->wbuf[i], fs->wsects[i]) != FR_OK)
+						return FR_DISK_ERR;
+					fs->wdirty[i] = 0;
+				}
+#endif
+				swap_window(fs, i);
+				touch_window(fs, n);
+			}
+			fs->winsect = 0;
+			fs->wflag = 0;
+			if (disk_read(fs->drv, fs->win, sector, 1) != RES_OK)
+				return FR_DISK_ERR;
+			fs->winsect = sector;
+			return FR_OK;
+		}
+#endif
 #if !_FS_READONLY
 		if (fs->wflag) {	/* Write back dirty window if needed */
-			if (disk_write(fs->drv, fs->win, wsect, 1) != RES_OK)
+			if (write_window(fs, fs->win, wsect) != FR_OK)
 				return FR_DISK_ERR;
 			fs->wflag = 0;
-			if (wsect < (fs->fatbase + fs->fsize)) {	/* In FAT area */
-				BYTE nf;
-				for (nf = fs->n_fats; nf > 1; nf--) {	/* Reflect the change to all FAT copies */
-					wsect += fs->fsize;
-					disk_write(fs->drv, fs->win, wsect, 1);
-				}
-			}
 		}
 #endif
 		if (sector) {
@@ -746,6 +858,11 @@ FRESULT move_window (
 			fs->winsect = sector;
 		}
 	}
+#if _FS_WINS > 1
+	else if (sector) {
+		fs->whits++;
+	}
+#endif
 
 	return FR_OK;
 }
@@ -763,9 +880,20 @@ FRESULT sync (	/* FR_OK: successful, FR_DISK_ERR: failed */
 )
 {
 	FRESULT res;
+#if _FS_WINS > 1
+	BYTE i;
+#endif
 
 
 	res = move_window(fs, 0);
+#if _FS_WINS > 1
+	for (i = 0; i < _FS_WINS - 1 && res == FR_OK; i++) {	/* Write back the cache */
+		if (fs->wdirty[i]) {
+			res = write_window(fs, fs->wbuf[i], fs->wsects[i]);
+			fs->wdirty[i] = 0;
+		}
+	}
+#endif
 	if (res == FR_OK) {
 		/* Update FSInfo sector if needed */
 		if (fs->fs_type == FS_FAT32 && fs->fsi_flag) {
@@ -1974,6 +2102,57 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 
 
 
+#if _USE_DIRHINT
+/*-----------------------------------------------------------------------*/
+/* Follow a file path, trying the entry location hint first              */
+/*-----------------------------------------------------------------------*/
+
+static
+FRESULT follow_hint (	/* FR_OK(0): successful, !=0: error code */
+	DIR *dj,			/* Directory object to return last directory and found object */
+	const TCHAR *path,	/* Full-path string to find a file or directory */
+	FILHINT *hint		/* Entry location hint (updated on a miss) */
+)
+{
+	FRESULT res;
+	const TCHAR *p = path;
+
+
+	if (*p == '/' || *p == '\\')		/* Strip heading separator if exist */
+		p++;
+	dj->sclust = 0;						/* The hint is for the root dir only */
+#if _FS_RPATH
+	if (p == path) dj->sclust = dj->fs->cdir;	/* Relative path starts from the current dir */
+#endif
+	if (!dj->sclust &&
+		hint->vsn && hint->vsn == dj->fs->vsn &&	/* Same volume? */
+		create_name(dj, &p) == FR_OK && (dj->fn[NS] & NS_LAST) &&
+		!(dj->fn[NS] & (NS_DOT | NS_LOSS)) &&
+		dir_sdi(dj, hint->index) == FR_OK && dj->sect == hint->sect) {	/* Entry is in the root dir */
+		res = move_window(dj->fs, dj->sect);	/* The only sector read */
+		if (res != FR_OK) return res;
+		if (!(dj->dir[DIR_Attr] & AM_VOL) && !mem_cmp(dj->dir, dj->fn, 11)) {	/* Still the same SFN? */
+#if _USE_LFN
+			dj->lfn_idx = 0xFFFF;
+#endif
+			dj->fs->dhits++;
+			return FR_OK;
+		}
+	}
+
+	res = follow_path(dj, path);		/* Miss: scan the directory */
+	if (res == FR_OK && dj->dir && !dj->sclust) {	/* Found in the root dir, remember where */
+		hint->vsn = dj->fs->vsn;
+		hint->sect = dj->sect;
+		hint->index = dj->index;
+	}
+	return res;
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Load a sector and check if it is an FAT Volume Boot Record            */
 /*-----------------------------------------------------------------------*/
@@ -2053,6 +2232,9 @@ FRESULT chk_mounted (	/* FR_OK(0): successful, !=0: any error occurred */
 
 	fs->fs_type = 0;					/* Clear the file system object */
 	fs->drv = LD2PD(vol);				/* Bind the logical drive and a physical drive */
+#if _FS_WINS > 1
+	init_windows(fs);					/* Empty window cache */
+#endif
 	stat = disk_initialize(fs->drv);	/* Initialize low level disk I/O layer */
 	if (stat & STA_NOINIT)				/* Check if the initialization succeeded */
 		return FR_NOT_READY;			/* Failed to initialize due to no media or hard error */
@@ -2112,6 +2294,11 @@ FRESULT chk_mounted (	/* FR_OK(0): successful, !=0: any error occurred */
 	if (nclst >= MIN_FAT16) fmt = FS_FAT16;
 	if (nclst >= MIN_FAT32) fmt = FS_FAT32;
 
+#if _USE_DIRHINT
+	fs->vsn = LD_DWORD(fs->win + ((fmt == FS_FAT32) ? BS_VolID32 : BS_VolID));	/* Volume serial number */
+	fs->dhits = 0;
+#endif
+
 	/* Boundaries and Limits */
 	fs->n_fatent = nclst + 2;							/* Number of FAT entries */
 	fs->database = bsect + sysect;						/* Data start sector */
@@ -2240,11 +2427,36 @@ FRESULT f_mount (
 /* Open or Create a File                                                 */
 /*-----------------------------------------------------------------------*/
 
+#if _USE_DIRHINT
 FRESULT f_open (
 	FIL *fp,			/* Pointer to the blank file object */
 	const TCHAR *path,	/* Pointer to the file name */
 	BYTE mode			/* Access mode and file open mode flags */
 )
+{
+	return f_openhint(fp, path, mode, 0);
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Open or Create a File by its Entry Location Hint                      */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_openhint (
+	FIL *fp,			/* Pointer to the blank file object */
+	const TCHAR *path,	/* Pointer to the file name */
+	BYTE mode,			/* Access mode and file open mode flags */
+	FILHINT *hint		/* Pointer to the entry location hint (0:Not used) */
+)
+#else
+FRESULT f_open (
+	FIL *fp,			/* Pointer to the blank file object */
+	const TCHAR *path,	/* Pointer to the file name */
+	BYTE mode			/* Access mode and file open mode flags */
+)
+#endif
 {
 	FRESULT res;
 	DIR dj;
@@ -2262,6 +2474,11 @@ FRESULT f_open (
 	res = chk_mounted(&path, &dj.fs, 0);
 #endif
 	INIT_BUF(dj);
+#if _USE_DIRHINT
+	if (res == FR_OK && hint)
+		res = follow_hint(&dj, path, hint);	/* Follow the file path, try the hint first */
+	else
+#endif
 	if (res == FR_OK)
 		res = follow_path(&dj, path);	/* Follow the file path */
 	dir = dj.dir;
@@ -2381,6 +2598,9 @@ FRESULT f_read (
 	DWORD clst, sect, remain;
 	UINT rcnt, cc;
 	BYTE csect, *rbuff = buff;
+#if !_FS_READONLY && _FS_MINIMIZE <= 2 && _FS_TINY && _FS_WINS > 1
+	BYTE i;
+#endif
 
 
 	*br = 0;	/* Initialize byte counter */
@@ -2424,6 +2644,12 @@ FRESULT f_read (
 					ABORT(fp->fs, FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */
 #if _FS_TINY
+#if _FS_WINS > 1
+				for (i = 0; i < _FS_WINS - 1; i++) {	/* Dirty sectors in the window cache (win[] is newer) */
+					if (fp->fs->wdirty[i] && fp->fs->wsects[i] - sect < cc)
+						mem_cpy(rbuff + ((fp->fs->wsects[i] - sect) * SS(fp->fs)), fp->fs->wbuf[i], SS(fp->fs));
+				}
+#endif
 				if (fp->fs->wflag && fp->fs->winsect - sect < cc)
 					mem_cpy(rbuff + ((fp->fs->winsect - sect) * SS(fp->fs)), fp->fs->win, SS(fp->fs));
 #else
@@ -2483,6 +2709,9 @@ FRESULT f_write (
 	UINT wcnt, cc;
 	const BYTE *wbuff = buff;
 	BYTE csect;
+#if _FS_TINY && _FS_WINS > 1
+	BYTE i;
+#endif
 
 
 	*bw = 0;	/* Initialize byte counter */
@@ -2541,6 +2770,14 @@ FRESULT f_write (
 					mem_cpy(fp->fs->win, wbuff + ((fp->fs->winsect - sect) * SS(fp->fs)), SS(fp->fs));
 					fp->fs->wflag = 0;
 				}
+#if _FS_WINS > 1
+				for (i = 0; i < _FS_WINS - 1; i++) {	/* Drop the window cache copies */
+					if (fp->fs->wsects[i] - sect < cc) {
+						fp->fs->wsects[i] = 0;
+						fp->fs->wdirty[i] = 0;
+					}
+				}
+#endif
 #else
 				if (fp->dsect - sect < cc) { /* Refill sector cache if it gets invalidated by the direct write */
 					mem_cpy(fp->buf, wbuff + ((fp->dsect - sect) * SS(fp->fs)), SS(fp->fs));
@@ -2954,6 +3191,44 @@ FRESULT f_lseek (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Get Start Sector of a Contiguous File                                 */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_contiguous (
+	FIL *fp,		/* Pointer to the file object */
+	DWORD *sect		/* Pointer to return the first sector (0: fragmented or empty) */
+)
+{
+	FRESULT res;
+	DWORD cl, ncl, n;
+
+
+	*sect = 0;
+	res = validate(fp->fs, fp->id);		/* Check validity of the object */
+	if (res != FR_OK) LEAVE_FF(fp->fs, res);
+	if (!fp->sclust) LEAVE_FF(fp->fs, FR_OK);
+
+#if _USE_FASTSEEK
+	if (fp->cltbl) {					/* A single fragment in the CLMT? */
+		if (fp->cltbl[0] == 4)
+			*sect = clust2sect(fp->fs, fp->cltbl[2]);
+		LEAVE_FF(fp->fs, FR_OK);
+	}
+#endif
+	n = (fp->fsize + SS(fp->fs) * fp->fs->csize - 1) / (SS(fp->fs) * fp->fs->csize);	/* Clusters in the file */
+	for (cl = fp->sclust; n > 1; n--, cl = ncl) {	/* Follow the chain while it is consecutive */
+		ncl = get_fat(fp->fs, cl);
+		if (ncl == 0xFFFFFFFF) LEAVE_FF(fp->fs, FR_DISK_ERR);
+		if (ncl != cl + 1) LEAVE_FF(fp->fs, FR_OK);	/* Fragmented */
+	}
+	*sect = clust2sect(fp->fs, fp->sclust);
+
+	LEAVE_FF(fp->fs, FR_OK);
+}
+
+
+
 #if _FS_MINIMIZE <= 1
 /*-----------------------------------------------------------------------*/
 /* Create a Directroy Object                                             */
@@ -3520,6 +3795,11 @@ FRESULT f_forward (
 		csect = (BYTE)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			if (!csect) {							/* On the cluster boundary? */
+#if _USE_FASTSEEK
+				if (fp->fptr && fp->cltbl)
+					clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
+				else
+#endif
 				clst = (fp->fptr == 0) ?			/* On the top of the file? */
 					fp->sclust : get_fat(fp->fs, fp->clust);
 				if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
@@ -3577,6 +3857,9 @@ FRESULT f_mkfs (
 	fs = FatFs[drv];
 	if (!fs) return FR_NOT_ENABLED;
 	fs->fs_type = 0;
+#if _FS_WINS > 1
+	init_windows(fs);
+#endif
 	pdrv = LD2PD(drv);	/* Physical drive */
 	part = LD2PT(drv);	/* Partition (0:auto detect, 1-4:get from partition table)*/
 
@@ -102,8 +102,20 @@ typedef struct {
 	DWORD	fatbase;		/* FAT start sector */
 	DWORD	dirbase;		/* Root directory start sector (FAT32:Cluster#) */
 	DWORD	database;		/* Data start sector */
+#if _USE_DIRHINT
+	DWORD	vsn;			/* Volume serial number */
+	DWORD	dhits;			/* f_openhint() found the entry by the hint */
+#endif
 	DWORD	winsect;		/* Current sector appearing in the win[] */
 	BYTE	win[_MAX_SS];	/* Disk access window for Directory, FAT (and Data on tiny cfg) */
+#if _FS_WINS > 1
+	DWORD	whits;			/* move_window() found the sector in win[] or the cache */
+	DWORD	wmisses;		/* move_window() had to read the sector */
+	DWORD	wsects[_FS_WINS - 1];	/* Sectors in the cache windows (0:empty) */
+	BYTE	wdirty[_FS_WINS - 1];	/* Cache window dirty flags */
+	BYTE	wlru[_FS_WINS - 1];	/* Cache window indexes, most recently used first */
+	BYTE	wbuf[_FS_WINS - 1][_MAX_SS];	/* Sectors recently moved away from win[] */
+#endif
 } FATFS;
 
 
@@ -156,6 +168,16 @@ typedef struct {
 
 
 
+/* Location of a directory entry in the root directory (FILHINT) */
+
+typedef struct {
+	DWORD	vsn;			/* Volume serial number (0:No hint) */
+	DWORD	sect;			/* Sector of the entry */
+	WORD	index;			/* Index of the entry in the root directory */
+} FILHINT;
+
+
+
 /* File status structure (FILINFO) */
 
 typedef struct {
@@ -206,6 +228,8 @@ FRESULT f_mount (BYTE, FATFS*);						/* Mount/Unmount a logical drive */
 FRESULT f_open (FIL*, const TCHAR*, BYTE);			/* Open or create a file */
 FRESULT f_read (FIL*, void*, UINT, UINT*);			/* Read data from a file */
 FRESULT f_lseek (FIL*, DWORD);						/* Move file pointer of a file object */
+FRESULT f_contiguous (FIL*, DWORD*);				/* Get the start sector of a contiguous file */
+FRESULT f_openhint (FIL*, const TCHAR*, BYTE, FILHINT*);	/* Open a file by its entry location hint */
 FRESULT f_close (FIL*);								/* Close an open file object */
 FRESULT f_opendir (DIR*, const TCHAR*);				/* Open an existing directory */
 FRESULT f_readdir (DIR*, FILINFO*);					/* Read a directory item */
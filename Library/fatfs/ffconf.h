@@ -44,14 +44,31 @@
 /* To enable f_mkfs function, set _USE_MKFS to 1 and set _FS_READONLY to 0 */
 
 
-#define	_USE_FORWARD	0	/* 0:Disable or 1:Enable */
+#define	_USE_FORWARD	1	/* 0:Disable or 1:Enable */
 /* To enable f_forward function, set _USE_FORWARD to 1 and set _FS_TINY to 1. */
 
 
-#define	_USE_FASTSEEK	0	/* 0:Disable or 1:Enable */
+#define	_USE_FASTSEEK	1	/* 0:Disable or 1:Enable */
 /* To enable fast seek feature, set _USE_FASTSEEK to 1. */
 
 
+#define	_USE_DIRHINT	1	/* 0:Disable or 1:Enable */
+/* To enable f_openhint function, set _USE_DIRHINT to 1. f_openhint opens a file
+/  in the root directory by a saved location of its entry (FILHINT) with a single
+/  sector read, and falls back to the directory scan when it does not match. */
+
+
+#ifndef _FS_WINS
+#define	_FS_WINS		4	/* 1 to 16 */
+#endif
+/* Number of sector windows in the file system object. 1 is the original single
+/  fs->win[]. With 2 or more, move_window() keeps the last _FS_WINS-1 sectors it
+/  moved away from in an LRU cache and swaps them back into win[] on a hit, so
+/  FAT, directory and (on tiny cfg) data accesses do not evict each other.
+/  Dirty windows are written back on eviction and sync. Each window adds
+/  _MAX_SS bytes to the FATFS object. */
+
+
 
 /*---------------------------------------------------------------------------/
 / Locale and Namespace Configurations
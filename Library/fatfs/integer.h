@@ -28,9 +28,15 @@ typedef unsigned short	WORD;
 typedef unsigned short	WCHAR;
 
 /* These types must be 32-bit integer */
+#ifdef __LP64__		/* Host build (host/): long is 64-bit there */
+typedef int				LONG;
+typedef unsigned int	ULONG;
+typedef unsigned int	DWORD;
+#else
 typedef long			LONG;
 typedef unsigned long	ULONG;
 typedef unsigned long	DWORD;
+#endif
 
 #endif
 
@@ -0,0 +1,129 @@
+/******************************************************************************
+ *    ,     flash.
+ *    ,      
+ *****************************************************************************/
+#include <string.h>
+#include "delta.h"
+#include "flash.h"
+
+
+/**
+ *        base (  
+ *  ).      dh.
+ * 0 -      
+ */
+int delta_start(delta_t * d, delta_in_t in, u32 base, const delta_header_t * dh)
+{
+    memset(d, 0, sizeof(*d));
+    if (dh->magic != DELTA_MAGIC)
+	return 0;
+
+    d->in = in;
+    d->base = base;
+    d->base_end = base + dh->base_size;
+    d->old = base;
+    d->out = base;
+    return 1;
+}
+
+
+/**
+ *   [from, from + len)       to:
+ *    
+ */
+void delta_copy(delta_t * d, u32 from, u32 len, u32 to)
+{
+    d->copy_from = from;
+    d->copy_len = len;
+    d->copy_to = to;
+}
+
+
+/*     addr. -1 -   ,     */
+IDEF int delta_old(delta_t * d, u32 addr)
+{
+    const flash_sector_t *sec;
+
+    /*      */
+    if (d->out >= d->lo_end || d->out < d->lo) {
+	if ((sec = flash_sector(flash_sector_find(d->out))) == NULL)
+	    return -1;
+	d->lo = sec->addr;
+	d->lo_end = sec->addr + sec->size;
+    }
+
+    if (addr < d->lo || addr < d->base || addr >= d->base_end)
+	return -1;
+    if (addr - d->copy_from < d->copy_len)
+	return *(const u8 *) (d->copy_to + (addr - d->copy_from));
+    return *(const u8 *) addr;
+}
+
+
+/**
+ *  len     buf.
+ *    ( len -  ), -1 - 
+ */
+int delta_read(delta_t * d, u8 * buf, int len)
+{
+    delta_cmd_t cmd;
+    int n = 0, k, i, c;
+
+    while (n < len) {
+	if (d->diff) {
+	    k = (d->diff < (u32) (len - n)) ? d->diff : len - n;
+	    if (d->in(buf + n, k) != k)
+		return -1;
+	    for (i = 0; i < k; i++) {
+		if ((c = d->skip ? 0 : delta_old(d, d->old)) < 0)
+		    return -1;
+		buf[n + i] += c;
+		d->old++;
+		d->out++;
+	    }
+	    d->diff -= k;
+	} else if (d->extra) {
+	    k = (d->extra < (u32) (len - n)) ? d->extra : len - n;
+	    if (d->in(buf + n, k) != k)
+		return -1;
+	    d->out += k;
+	    d->extra -= k;
+	} else {
+	    /*   */
+	    d->old += d->seek;
+	    d->seek = 0;
+	    k = d->in(&cmd, sizeof(cmd));
+	    if (k == 0)
+		break;
+	    if (k != sizeof(cmd))
+		return -1;
+	    d->diff = cmd.diff_len;
+	    d->extra = cmd.extra_len;
+	    d->seek = cmd.seek;
+	    continue;
+	}
+	n += k;
+    }
+    return n;
+}
+
+
+/**
+ *  len   :     flash ().
+ *         -    .
+ * 0 -     
+ */
+int delta_skip(delta_t * d, u32 len)
+{
+    u8 tmp[64];
+    int k = 1;
+
+    d->skip = 1;
+    while (len > 0 && k > 0) {
+	k = delta_read(d, tmp, (len < sizeof(tmp)) ? len : sizeof(tmp));
+	if (k > 0)
+	    len -= k;
+    }
+    d->skip = 0;
+    return len == 0;
+}
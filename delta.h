@@ -0,0 +1,54 @@
+#ifndef _DELTA_H
+#define _DELTA_H
+
+#include "globdefs.h"
+
+
+#define DELTA_MAGIC		0x31544C44	/* "DLT1" */
+
+/**
+ *  (   IMAGE_FLAG_DELTA)   bsdiff:
+ * delta_header_t,   delta_cmd_t,    :
+ * diff_len   ( =  + ,  ),
+ * extra_len    ,     
+ *   seek.  little-endian.
+ *
+ *    ,      
+ *    ,     :  
+ *  .      (delta_copy)
+ */
+typedef struct {
+    u32 magic;			/* DELTA_MAGIC */
+    u32 base_size;		/*  ,     */
+    u32 base_crc;		/*  CRC-32 (   CRC) */
+} delta_header_t;
+
+typedef struct {
+    u32 diff_len;
+    u32 extra_len;
+    s32 seek;
+} delta_cmd_t;
+
+/*    :  image_read() */
+typedef int (*delta_in_t) (void *, int);
+
+typedef struct {
+    delta_in_t in;
+    u32 base, base_end;		/*    flash */
+    u32 old;			/*    */
+    u32 out;			/*     */
+    u32 lo, lo_end;		/*  :   lo   */
+    u32 copy_from, copy_len;	/*      copy_to */
+    u32 copy_to;
+    u32 diff, extra;		/*     */
+    s32 seek;
+    u8 skip;			/* delta_skip():     */
+} delta_t;
+
+
+int delta_start(delta_t *, delta_in_t, u32, const delta_header_t *);
+int delta_read(delta_t *, u8 *, int);
+int delta_skip(delta_t *, u32);
+void delta_copy(delta_t *, u32, u32, u32);
+
+#endif /* delta.h */
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *    ELF32 (   ):   
+ * PT_LOAD,     (p_paddr),  p_filesz 
+ *****************************************************************************/
+#include <string.h>
+#include "elf.h"
+
+
+#define ET_EXEC			2
+#define EM_ARM			40
+#define PT_LOAD			1
+
+
+/**
+ *         .
+ *        .
+ * 0 -   ELF
+ */
+int elf_init(elf_t * e, const elf_ehdr_t * eh, const elf_phdr_t * ph)
+{
+    elf_seg_t s;
+    int i, j;
+
+    memset(e, 0, sizeof(*e));
+    if (*(const u32 *) eh->e_ident != ELF_MAGIC ||
+	eh->e_ident[4] != 1 || eh->e_ident[5] != 1 ||	/* 32 , little-endian */
+	eh->e_type != ET_EXEC || eh->e_machine != EM_ARM ||
+	eh->e_phentsize != sizeof(elf_phdr_t) || eh->e_phnum > ELF_PHNUM_MAX)
+	return 0;
+
+    for (i = 0; i < eh->e_phnum; i++) {
+	/* .bss   -  p_memsz,  flash    */
+	if (ph[i].p_type != PT_LOAD || ph[i].p_filesz == 0)
+	    continue;
+
+	/*  -   */
+	s.offset = ph[i].p_offset;
+	s.addr = ph[i].p_paddr;
+	s.size = ph[i].p_filesz;
+	for (j = e->nseg; j > 0 && e->seg[j - 1].addr > s.addr; j--)
+	    e->seg[j] = e->seg[j - 1];
+	e->seg[j] = s;
+	e->nseg++;
+    }
+
+    for (i = 1; i < e->nseg; i++) {
+	if (e->seg[i].addr < e->seg[i - 1].addr + e->seg[i - 1].size)
+	    return 0;
+    }
+    return e->nseg > 0;
+}
+
+
+/*     out ( ,    ) */
+void elf_start(elf_t * e, u32 out)
+{
+    e->cur = 0;
+    e->out = out;
+}
+
+
+/**
+ *   ,   max:  *offset -  
+ *  ,  ELF_GAP -    (0xFF).
+ *   , 0 -  
+ */
+int elf_next(elf_t * e, int max, u32 * offset)
+{
+    const elf_seg_t *s;
+    u32 k;
+
+    while (e->cur < e->nseg) {
+	s = &e->seg[e->cur];
+	if (e->out >= s->addr + s->size) {
+	    e->cur++;
+	    continue;
+	}
+
+	if (e->out < s->addr) {
+	    k = s->addr - e->out;
+	    *offset = ELF_GAP;
+	} else {
+	    k = s->addr + s->size - e->out;
+	    *offset = s->offset + (e->out - s->addr);
+	}
+	if (k > (u32) max)
+	    k = max;
+	e->out += k;
+	return k;
+    }
+    return 0;
+}
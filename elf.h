@@ -0,0 +1,63 @@
+#ifndef _ELF_H
+#define _ELF_H
+
+#include "globdefs.h"
+
+
+#define ELF_MAGIC		0x464C457F	/* "\x7FELF" */
+#define ELF_PHNUM_MAX		16	/*     in_buf */
+#define ELF_GAP			0xFFFFFFFF	/* elf_next(): ,    */
+
+/*  ELF32 -  ,    */
+typedef struct {
+    u8 e_ident[16];
+    u16 e_type;
+    u16 e_machine;
+    u32 e_version;
+    u32 e_entry;
+    u32 e_phoff;
+    u32 e_shoff;
+    u32 e_flags;
+    u16 e_ehsize;
+    u16 e_phentsize;
+    u16 e_phnum;
+    u16 e_shentsize;
+    u16 e_shnum;
+    u16 e_shstrndx;
+} elf_ehdr_t;
+
+typedef struct {
+    u32 p_type;
+    u32 p_offset;
+    u32 p_vaddr;
+    u32 p_paddr;
+    u32 p_filesz;
+    u32 p_memsz;
+    u32 p_flags;
+    u32 p_align;
+} elf_phdr_t;
+
+/*   :   ,   flash (LMA),  */
+typedef struct {
+    u32 offset;
+    u32 addr;
+    u32 size;
+} elf_seg_t;
+
+/**
+ *    PT_LOAD,    .
+ * ,        
+ */
+typedef struct {
+    elf_seg_t seg[ELF_PHNUM_MAX];
+    int nseg;
+    int cur;			/*   */
+    u32 out;			/*     */
+} elf_t;
+
+
+int elf_init(elf_t *, const elf_ehdr_t *, const elf_phdr_t *);
+void elf_start(elf_t *, u32);
+int elf_next(elf_t *, int, u32 *);
+
+#endif /* elf.h */
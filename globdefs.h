@@ -106,6 +106,17 @@ typedef unsigned char bool;
 #endif
 
 
+/* ,     (,  flash ).
+ * IAR  __ramfunc  .textrw, .  RAMCODE  stm32f4xx_flash.icf */
+#ifndef RAMFUNC
+#if defined(__ICCARM__)
+#define RAMFUNC __ramfunc
+#else
+#define RAMFUNC __attribute__ ((section(".textrw")))
+#endif
+#endif
+
+
 
 
 #endif				/* globdefs.h */
@@ -0,0 +1,250 @@
+/******************************************************************************
+ *  Intel HEX  Motorola S-record:  ,  
+ *   .      ,  
+ * flash    ,    .bin
+ *****************************************************************************/
+#include <string.h>
+#include "hexrec.h"
+
+
+/*   */
+#define ST_IDLE			0	/*   */
+#define ST_TYPE			1	/*    'S' */
+#define ST_HEX			2	/*  hex- */
+
+/*  hex-   , 0xFF -   */
+static const u8 nib[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static int hexrec_parse(hexrec_t *, const u8 **, int *);
+static int hexrec_record(hexrec_t *);
+
+
+/*     ;      out */
+void hexrec_init(hexrec_t * h, u32 out)
+{
+    memset(h, 0, sizeof(*h));
+    h->out = out;
+}
+
+
+/**
+ *      .
+ * 1 -   rec , 0 -   , -1 -  
+ */
+static int hexrec_parse(hexrec_t * h, const u8 ** in, int *inlen)
+{
+    const u8 *p = *in, *end = p + *inlen;
+    int res = 0;
+    u8 c, v;
+
+    while (p < end && res == 0) {
+	c = *p++;
+
+	switch (h->state) {
+	case ST_IDLE:
+	    if (c == ':' && h->fmt != HEXREC_SREC) {
+		h->fmt = HEXREC_IHEX;
+		h->state = ST_HEX;
+	    } else if (c == 'S' && h->fmt != HEXREC_IHEX) {
+		h->fmt = HEXREC_SREC;
+		h->state = ST_TYPE;
+	    } else if (c != '\r' && c != '\n' && c != ' ' && c != '\t') {
+		res = -1;
+	    }
+	    h->n = 0;
+	    h->need = 1;	/*     -    */
+	    break;
+
+	case ST_TYPE:
+	    if (c < '0' || c > '9')
+		res = -1;
+	    h->type = c;
+	    h->state = ST_HEX;
+	    break;
+
+	default:
+	    v = (c < sizeof(nib)) ? nib[c] : 0xFF;
+	    if (v == 0xFF) {
+		res = -1;
+		break;
+	    }
+	    if ((h->hi & 0x10) == 0) {
+		h->hi = v | 0x10;	/*    */
+		break;
+	    }
+	    h->rec[h->n++] = (u8) (h->hi << 4) | v;
+	    h->hi = 0;
+
+	    /*   -   */
+	    if (h->n == 1)
+		h->need = (h->fmt == HEXREC_IHEX) ? h->rec[0] + 5 : h->rec[0] + 1;
+	    if (h->n == h->need) {
+		h->state = ST_IDLE;
+		res = 1;
+	    }
+	    break;
+	}
+    }
+
+    *inlen -= p - *in;
+    *in = p;
+    return res;
+}
+
+
+/**
+ *   :  , , .
+ * 1 -   , 0 - , -1 - 
+ */
+static int hexrec_record(hexrec_t * h)
+{
+    const u8 *r = h->rec;
+    u8 sum = 0;
+    int i, alen;
+
+    for (i = 0; i < h->n; i++)
+	sum += r[i];
+    h->len = h->pos = 0;
+
+    if (h->fmt == HEXREC_IHEX) {
+	/*       - 0 */
+	if (sum != 0)
+	    return -1;
+	switch (r[3]) {
+	case 0x00:
+	    h->addr = h->base + ((r[1] << 8) | r[2]);
+	    h->data = 4;
+	    h->len = r[0];
+	    return 1;
+	case 0x01:
+	    h->eof = 1;
+	    return 0;
+	case 0x02:
+	    h->base = ((r[4] << 8) | r[5]) << 4;
+	    return (r[0] == 2) ? 0 : -1;
+	case 0x04:
+	    h->base = ((r[4] << 8) | r[5]) << 16;
+	    return (r[0] == 2) ? 0 : -1;
+	case 0x03:
+	case 0x05:
+	    return 0;		/*   -     */
+	default:
+	    return -1;
+	}
+    }
+
+    /* S-:       - 0xFF */
+    if (sum != 0xFF)
+	return -1;
+    switch (h->type) {
+    case '1':
+    case '2':
+    case '3':
+	alen = h->type - '1' + 2;
+	break;
+    case '7':
+    case '8':
+    case '9':
+	h->eof = 1;
+	return 0;
+    case '0':
+    case '5':
+    case '6':
+	return 0;
+    default:
+	return -1;
+    }
+    if (r[0] < alen + 1)
+	return -1;
+
+    h->addr = 0;
+    for (i = 1; i <= alen; i++)
+	h->addr = (h->addr << 8) | r[i];
+    h->data = 1 + alen;
+    h->len = r[0] - alen - 1;
+    return 1;
+}
+
+
+/**
+ *  ,  :     
+ *   (lo, hi_addr).    .
+ *   -  :    .
+ * 0 -   , -1 - 
+ */
+int hexrec_scan(hexrec_t * h, const u8 ** in, int *inlen)
+{
+    int r;
+
+    if (*inlen == 0)
+	return (h->state == ST_IDLE && h->hi_addr != 0) ? 0 : -1;
+
+    while (!h->eof && (r = hexrec_parse(h, in, inlen)) != 0) {
+	if (r < 0 || (r = hexrec_record(h)) < 0)
+	    return -1;
+	if (r == 0 || h->len == 0)
+	    continue;
+
+	if (h->hi_addr == 0)
+	    h->lo = h->addr;
+	else if (h->addr < h->hi_addr)
+	    return -1;		/*    */
+	h->hi_addr = h->addr + h->len;
+    }
+    return 0;
+}
+
+
+/**
+ *    outlen    out,  - 0xFF.
+ *    ; 0 -   
+ * (  ), -1 - 
+ */
+int hexrec_run(hexrec_t * h, const u8 ** in, int *inlen, u8 * out, int outlen)
+{
+    int n = 0, k, r;
+    u32 a;
+
+    while (n < outlen) {
+	if (h->pos < h->len) {
+	    a = h->addr + h->pos;
+	    if (a < h->out)
+		return -1;
+	    if (a > h->out) {
+		/*    */
+		k = (a - h->out < (u32) (outlen - n)) ? a - h->out : outlen - n;
+		memset(out + n, 0xFF, k);
+	    } else {
+		k = (h->len - h->pos < outlen - n) ? h->len - h->pos : outlen - n;
+		memcpy(out + n, h->rec + h->data + h->pos, k);
+		h->pos += k;
+	    }
+	    h->out += k;
+	    n += k;
+	    continue;
+	}
+
+	/*       */
+	if (h->eof) {
+	    *in += *inlen;
+	    *inlen = 0;
+	    break;
+	}
+
+	r = hexrec_parse(h, in, inlen);
+	if (r == 0)
+	    break;
+	if (r < 0 || hexrec_record(h) < 0)
+	    return -1;
+    }
+    return n;
+}
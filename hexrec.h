@@ -0,0 +1,40 @@
+#ifndef _HEXREC_H
+#define _HEXREC_H
+
+#include "globdefs.h"
+
+
+/*  ,      */
+#define HEXREC_IHEX		1	/* Intel HEX, ':' */
+#define HEXREC_SREC		2	/* Motorola S-record, 'S' */
+
+/*     : HEX - , (2), , 255 ,  */
+#define HEXREC_MAX		(1 + 2 + 1 + 255 + 1)
+
+/**
+ *  HEX/SREC .     , 
+ *       out:   
+ *  0xFF ( flash_write()  ).   
+ *     -   hexrec_scan()  
+ */
+typedef struct {
+    u8 fmt;			/* HEXREC_x */
+    u8 state;			/*     */
+    u8 type;			/*   S- */
+    u8 hi;			/*     */
+    u16 n, need;		/*       */
+    u8 rec[HEXREC_MAX];		/*     */
+    u16 data, len, pos;		/*  :   rec, ,  */
+    u32 base;			/*   HEX ( 02, 04) */
+    u32 addr;			/*    */
+    u32 out;			/*     */
+    u32 lo, hi_addr;		/* hexrec_scan():     */
+    u8 eof;			/*    */
+} hexrec_t;
+
+
+void hexrec_init(hexrec_t *, u32);
+int hexrec_scan(hexrec_t *, const u8 **, int *);
+int hexrec_run(hexrec_t *, const u8 **, int *, u8 *, int);
+
+#endif /* hexrec.h */
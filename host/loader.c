@@ -0,0 +1,168 @@
+/******************************************************************************
+ *   PC:  ,  main.c,     (sim*.c).
+ *    -  . Flash, backup SRAM   -
+ * ,     .    -
+ *  stdout  =
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "simcore.h"
+#include "main.h"
+#include "systick.h"
+#include "led.h"
+#include "update.h"
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+	    "usage: loader [options]\n"
+	    "  -d file   SD card image (sd.img), no file - no card\n"
+	    "  -f file   flash contents, 1M (flash.bin)\n"
+	    "  -b file   backup SRAM (backup.bin)\n"
+	    "  -V        no VBAT: backup SRAM is cleared at power-up\n"
+	    "  -c x      core cycles per ns of host code (0)\n"
+	    "  -s div    SPI prescaler instead of the driver's\n"
+	    "  -a us     card access time to the first block (500)\n"
+	    "  -g us     gap between CMD18 blocks (20)\n"
+	    "  -w us     card busy after a block write (500)\n"
+	    "  -x n      read error on block n\n"
+	    "  -p us     flash word program time (16)\n"
+	    "  -e a,b,c  16K,64K,128K sector erase, ms (250,550,1100)\n"
+	    "  -k n      power cut at the n-th flash operation\n"
+	    "  -t        trace card commands and erases to stderr\n");
+    exit(2);
+}
+
+
+/*  : overlap / (overlap + wait) */
+static double ratio(u32 overlap, u32 wait)
+{
+    return (overlap + wait) ? (double) overlap / ((double) overlap + wait) : 0.0;
+}
+
+
+static void print_stat(int res, u32 boot)
+{
+    const update_stat_t *u = update_get_stat();
+    const flash_stat_t *f = flash_get_stat();
+    const SD_Stat *sd = SD_GetStat();
+    double ms = sim_now() * 1000.0 / SIM_HZ;
+
+    printf("result=%d\n", res);
+    printf("time_ms=%.3f\n", ms);
+    printf("update_ms=%u\n", (unsigned) u->ms);
+    printf("images=%d\nerased=%d\nskipped=%d\nfragments=%d\nunmapped=%d\nresumed=%d\n",
+	   u->images, u->erased, u->skipped, u->fragments, u->unmapped, u->resumed);
+    printf("verify_errors=%d\nverify_cycles=%u\n", u->verify_errors, (unsigned) u->verify_cycles);
+    printf("sha_cycles=%u\nsign_cycles=%u\n", (unsigned) u->sha_cycles,
+	   (unsigned) u->sign_cycles);
+    printf("bytes=%u\nfile_bytes=%u\ndirect_bytes=%u\ncopy_bytes=%u\n",
+	   (unsigned) u->bytes, (unsigned) u->file_bytes, (unsigned) u->direct_bytes,
+	   (unsigned) u->copy_bytes);
+    printf("win_hits=%u\nwin_misses=%u\ndir_hits=%u\nversion=%u\n",
+	   (unsigned) u->win_hits, (unsigned) u->win_misses, (unsigned) u->dir_hits,
+	   (unsigned) u->version);
+    printf("sd_reads=%u\nsd_blocks=%u\nsd_hits=%u\nsd_streams=%u\nsd_late=%u\n",
+	   (unsigned) sd->Reads, (unsigned) sd->Blocks, (unsigned) sd->Hits,
+	   (unsigned) sd->Streams, (unsigned) sd->Late);
+    printf("sd_overlap=%u\nsd_wait=%u\nsd_overlap_ratio=%.3f\n",
+	   (unsigned) sd->CyclesOverlap, (unsigned) sd->CyclesWait,
+	   ratio(sd->CyclesOverlap, sd->CyclesWait));
+    printf("throughput_kbs=%.1f\n", ms > 0 ? u->bytes / 1.024 / ms : 0.0);
+    printf("flash_wait=%u\nflash_overlap=%u\nflash_skipped=%u\n",
+	   (unsigned) f->cycles_wait, (unsigned) f->cycles_overlap, (unsigned) f->skipped);
+    printf("sim_erases=%u\nsim_programs=%u\nsim_overprogram=%u\nsim_flash_errors=%u\n",
+	   sim_stat.erases, sim_stat.programs, sim_stat.overprogram, sim_stat.flash_errors);
+    printf("sim_cmds=%u\nsim_blocks_read=%u\nsim_blocks_written=%u\n",
+	   sim_stat.cmds, sim_stat.blocks_read, sim_stat.blocks_written);
+    printf("sim_spi_bytes=%llu\nsim_dma_bytes=%llu\nsim_dma_idle=%llu\n",
+	   (unsigned long long) sim_stat.spi_bytes, (unsigned long long) sim_stat.dma_bytes,
+	   (unsigned long long) sim_stat.dma_idle);
+    printf("sim_ramfunc_calls=%u\nsim_led_toggles=%u\n", sim_stat.ramfunc_calls,
+	   sim_stat.led_toggles);
+    printf("boot=0x%08X\n", (unsigned) boot);
+}
+
+
+int main(int argc, char **argv)
+{
+    BYTE pwr = 0;
+    u32 boot;
+    int c, res;
+
+    while ((c = getopt(argc, argv, "d:f:b:Vc:s:a:g:w:x:p:e:k:t")) != -1) {
+	switch (c) {
+	case 'd':
+	    sim.disk = optarg;
+	    break;
+	case 'f':
+	    sim.flash = optarg;
+	    break;
+	case 'b':
+	    sim.backup = optarg;
+	    break;
+	case 'V':
+	    sim.vbat = 0;
+	    break;
+	case 'c':
+	    sim.cpu = atof(optarg);
+	    break;
+	case 's':
+	    sim.spi_div = strtoul(optarg, NULL, 0);
+	    break;
+	case 'a':
+	    sim.card_access_us = strtoul(optarg, NULL, 0);
+	    break;
+	case 'g':
+	    sim.card_gap_us = strtoul(optarg, NULL, 0);
+	    break;
+	case 'w':
+	    sim.card_write_us = strtoul(optarg, NULL, 0);
+	    break;
+	case 'x':
+	    sim.card_fail = strtoul(optarg, NULL, 0) + 1;
+	    break;
+	case 'p':
+	    sim.prog_us = strtoul(optarg, NULL, 0);
+	    break;
+	case 'e':
+	    if (sscanf(optarg, "%u,%u,%u", &sim.erase_ms[0], &sim.erase_ms[1],
+		       &sim.erase_ms[2]) != 3)
+		usage();
+	    break;
+	case 'k':
+	    sim.cut = strtoul(optarg, NULL, 0);
+	    break;
+	case 't':
+	    sim.trace = 1;
+	    break;
+	default:
+	    usage();
+	}
+    }
+    if (optind != argc)
+	usage();
+
+    sim_init();
+
+    /*  -  main.c */
+    led_init();
+    systick_init();
+    cycles_init();
+    res = update_firmware();
+
+    disk_ioctl(0, CTRL_POWER, &pwr);
+
+#if UPDATE_AB
+    boot = slot_boot();
+#else
+    boot = APP_ADDRESS;
+#endif
+
+    print_stat(res, boot);
+    sim_done();
+    return 0;
+}
@@ -0,0 +1,271 @@
+/******************************************************************************
+ *  :  ,    SysTick.
+ *        (,  SPI, 
+ *  flash):    PC ,    sim.cpu.
+ *   (BSY, DMA, )    
+ *          
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "simcore.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_it.h"
+
+/* Unit    stm32f4xx_it.c */
+extern void SysTick_Handler(void) __attribute__ ((weak));
+
+
+/*         */
+#define SIM_POLL		4
+
+/*        flash  backup SRAM */
+#define SYSMEM_PAGE		0x1FFF7000	/* F_SIZE (0x1FFF7A22) */
+#define SCS_PAGE		0xE000E000	/* SysTick, NVIC, SCB, CoreDebug */
+#define F_SIZE_ADDR		0x1FFF7A22
+#define PAGE			0x1000
+
+
+sim_param_t sim = {
+    .disk = "sd.img",
+    .flash = "flash.bin",
+    .backup = "backup.bin",
+    .vbat = 1,
+    .card_access_us = 500,
+    .card_gap_us = 20,
+    .card_write_us = 500,
+    .prog_us = 16,
+    .erase_ms = {250, 550, 1100},
+};
+sim_stat_t sim_stat;
+uint32_t sim_dwt_ctrl;
+
+static uint64_t now;		/*     */
+static uint32_t cyccnt;		/* DWT_CYCCNT */
+static int depth;		/*     */
+static uint64_t events;		/*    () */
+static uint64_t host_ns;	/*  PC     (sim.cpu) */
+static uint64_t next_tick;	/*   SysTick, 0 -  */
+
+/*  :      */
+static struct {
+    int site;
+    uint64_t events;
+    int spins;
+} poll;
+
+
+static uint64_t host_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+/*   : ,     PC, -   */
+void sim_enter(void)
+{
+    uint64_t t;
+
+    if (depth++ > 0)
+	return;
+    events++;
+    if (sim.cpu > 0) {
+	t = host_time();
+	sim_advance((uint64_t) ((t - host_ns) * sim.cpu));
+    }
+}
+
+
+void sim_leave(void)
+{
+    if (--depth == 0 && sim.cpu > 0)
+	host_ns = host_time();
+}
+
+
+uint64_t sim_now(void)
+{
+    return now;
+}
+
+
+/*  :   -  SysTick,     */
+void sim_advance(uint64_t c)
+{
+    uint64_t period;
+
+    now += c;
+    cyccnt = (uint32_t) now;
+
+    if ((SysTick->CTRL & 3) != 3) {
+	next_tick = 0;
+	return;
+    }
+    period = (SysTick->LOAD & 0xFFFFFF) + 1;
+    if (next_tick == 0)
+	next_tick = now - c + period;
+    while (now >= next_tick) {
+	next_tick += period;
+	if (SysTick_Handler)
+	    SysTick_Handler();
+    }
+}
+
+
+/**
+ *   -,     until.  
+ *       -   :
+ *   
+ */
+void sim_wait(int site, uint64_t until)
+{
+    if (poll.site == site && poll.events + 1 == events)
+	poll.spins++;
+    else
+	poll.spins = 0;
+    poll.site = site;
+    poll.events = events;
+
+    if (poll.spins >= 3 && until > now)
+	sim_advance(until - now);
+    else
+	sim_advance(SIM_POLL);
+}
+
+
+/* __NOP()   :   SysTick */
+void sim_nop(void)
+{
+    sim_enter();
+    sim_wait(SIM_SITE_NOP, next_tick ? next_tick : now + 1);
+    sim_leave();
+}
+
+
+volatile uint32_t *sim_cyccnt(void)
+{
+    sim_enter();
+    sim_advance(1);
+    sim_leave();
+    return &cyccnt;
+}
+
+
+/*  :     flash, backup   -  */
+void sim_power_cut(const char *what)
+{
+    fprintf(stderr, "sim: power cut at %s, %.3f ms\n", what, now * 1000.0 / SIM_HZ);
+    _exit(SIM_EXIT_CUT);
+}
+
+
+/**
+ *   size     addr (0 -  ).
+ *      -   fill.
+ *        -   
+ */
+uint8_t *sim_map_file(const char *path, uint32_t addr, uint32_t size, int writable, uint8_t fill)
+{
+    struct stat st;
+    uint8_t *p, buf[PAGE];
+    off_t len;
+    size_t n;
+    int fd;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+	perror(path);
+	exit(2);
+    }
+    memset(buf, fill, sizeof(buf));
+    for (len = st.st_size; len < (off_t) size; len += n) {
+	n = (size - len < PAGE) ? size - len : PAGE;
+	if (pwrite(fd, buf, n, len) != (ssize_t) n) {
+	    perror(path);
+	    exit(2);
+	}
+    }
+
+    p = mmap((void *) (uintptr_t) addr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+	     MAP_SHARED | (addr ? MAP_FIXED_NOREPLACE : 0), fd, 0);
+    if (p == MAP_FAILED || (addr && p != (uint8_t *) (uintptr_t) addr)) {
+	fprintf(stderr, "sim: can't map %s at 0x%08X\n", path, addr);
+	exit(2);
+    }
+    close(fd);
+    return p;
+}
+
+
+/*     addr */
+static uint8_t *map_anon(uint32_t addr, uint32_t size)
+{
+    void *p = mmap((void *) (uintptr_t) addr, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p != (void *) (uintptr_t) addr) {
+	fprintf(stderr, "sim: can't map 0x%08X\n", addr);
+	exit(2);
+    }
+    return p;
+}
+
+
+/*   */
+void sim_init(void)
+{
+    map_anon(SYSMEM_PAGE, PAGE);
+    *(uint16_t *) F_SIZE_ADDR = 1024;
+    map_anon(SCS_PAGE, PAGE);
+
+    sim_map_file(sim.backup, BKPSRAM_BASE, PAGE, 1, 0);
+    if (!sim.vbat)
+	memset((void *) BKPSRAM_BASE, 0, PAGE);
+
+    sim_flash_init();
+    sim_sd_init();
+    host_ns = host_time();
+}
+
+
+/* :    */
+void sim_done(void)
+{
+    msync((void *) BKPSRAM_BASE, PAGE, MS_SYNC);
+}
+
+
+/**
+ *  RAMFUNC (-finstrument-functions):   BSY
+ *   flash  .      ramfunc
+ *    ,  - 
+ */
+extern char __start_ramfunc[] __attribute__ ((weak));
+extern char __stop_ramfunc[] __attribute__ ((weak));
+void *sim_ramfunc_first;
+
+__attribute__ ((no_instrument_function))
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    (void) site;
+    if (depth == 0 && sim_flash_busy() &&
+	!((char *) fn >= __start_ramfunc && (char *) fn < __stop_ramfunc)) {
+	if (sim_stat.ramfunc_calls++ == 0)
+	    sim_ramfunc_first = fn;
+    }
+}
+
+__attribute__ ((no_instrument_function))
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    (void) fn;
+    (void) site;
+}
@@ -0,0 +1,35 @@
+/******************************************************************************
+ *   PC (host/Makefile):     
+ *  -include.  FLASH,   flash    DWT
+ *    (sim_flash.c, sim.c), SPI, DMA  GPIO  -
+ *   StdPeriph  sim_sd.c,  - sim_periph.c
+ *****************************************************************************/
+#ifndef _SIM_H
+#define _SIM_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+/*    FLASH->    ,  
+ *   ,    */
+#undef FLASH
+#define FLASH			(sim_flash_regs())
+
+/*   flash (flash.h):   PG, PSIZE  BSY */
+#define FLASH_STORE(type, addr, v)	sim_flash_store((addr), (v), sizeof(type))
+
+#define DWT_CYCCNT		(*sim_cyccnt())
+#define DWT_CTRL		(sim_dwt_ctrl)
+
+/*  Cortex-M,    PC */
+#define __REV(x)		__builtin_bswap32(x)
+#define __NOP()			sim_nop()
+
+
+FLASH_TypeDef *sim_flash_regs(void);
+void sim_flash_store(uint32_t, uint64_t, int);
+volatile uint32_t *sim_cyccnt(void);
+void sim_nop(void);
+extern uint32_t sim_dwt_ctrl;
+
+#endif /* sim.h */
@@ -0,0 +1,251 @@
+/******************************************************************************
+ *  flash STM32F407 (1):  FLASH   .
+ *    0x08000000    -    
+ * FLASH_STORE() .  -  :  
+ *   ,      (FLASH->
+ *  sim.h -  sim_flash_regs()).     - 
+ *  datasheet STM32F407 (typ),     loader
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simcore.h"
+#include "stm32f4xx.h"
+
+
+#define FLASH_MEM		0x08000000
+#define FLASH_MEM_SIZE		0x100000
+#define KEY1			0x45670123
+#define KEY2			0xCDEF89AB
+
+/*  SR,      ():   - 
+ *  SR,       */
+#define SR_MARK			0x80000000
+#define SR_ERRORS		(FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+				 FLASH_SR_PGPERR | FLASH_SR_PGSERR)
+
+#define CR_SNB			0x000000F8
+#define CR_PSIZE		0x00000300
+
+#define OP_NONE			0
+#define OP_ERASE		1
+#define OP_PROGRAM		2
+
+
+/* : 4 x 16K, 1 x 64K, 7 x 128K */
+static const struct {
+    uint32_t addr, size;
+} sectors[] = {
+    {0x08000000, 0x4000}, {0x08004000, 0x4000}, {0x08008000, 0x4000}, {0x0800C000, 0x4000},
+    {0x08010000, 0x10000}, {0x08020000, 0x20000}, {0x08040000, 0x20000}, {0x08060000, 0x20000},
+    {0x08080000, 0x20000}, {0x080A0000, 0x20000}, {0x080C0000, 0x20000}, {0x080E0000, 0x20000},
+};
+
+static FLASH_TypeDef regs;
+static uint32_t status;		/*  SR:  regs.SR    */
+static uint8_t *mem;		/*   flash,    */
+static int keys;		/*   KEYR  */
+static uint64_t last;		/*    */
+static uint32_t ops;		/*       */
+
+/*   */
+static struct {
+    int kind;
+    int sector;
+    uint64_t start, end;
+} op;
+
+
+/*    n  PSIZE psize */
+static uint64_t erase_time(int n, int psize)
+{
+    static const double scale[4] = { 1.6, 1.2, 1.0, 1.0 };	/* x8, x16, x32, x64 */
+    int k = (sectors[n].size == 0x4000) ? 0 : (sectors[n].size == 0x10000) ? 1 : 2;
+
+    return (uint64_t) (SIM_MS(sim.erase_ms[k]) * scale[psize]);
+}
+
+
+/*    :     */
+static void cut(const char *what, uint32_t addr, uint32_t len, int erase)
+{
+    uint32_t i, r = 0x9E3779B9 * ops;
+
+    for (i = 0; i < len; i++) {
+	r = r * 1103515245 + 12345;
+	if (erase)
+	    mem[addr - FLASH_MEM + i] |= (uint8_t) (r >> 16);
+	else
+	    mem[addr - FLASH_MEM + i] &= (uint8_t) (r >> 16);
+    }
+    sim_power_cut(what);
+}
+
+
+/*   */
+static void finish(void)
+{
+    if (op.kind == OP_ERASE)
+	memset(mem + sectors[op.sector].addr - FLASH_MEM, 0xFF, sectors[op.sector].size);
+    sim_stat.flash_busy += op.end - op.start;
+    op.kind = OP_NONE;
+    status &= ~FLASH_SR_BSY;
+    regs.CR &= ~FLASH_CR_STRT;
+}
+
+
+/*  :  STRT */
+static void erase_start(uint64_t t)
+{
+    int n = (regs.CR & CR_SNB) >> 3;
+    char what[32];
+
+    if (!(regs.CR & FLASH_CR_SER) || n >= (int) (sizeof(sectors) / sizeof(sectors[0]))) {
+	status |= FLASH_SR_PGSERR;
+	regs.CR &= ~FLASH_CR_STRT;
+	sim_stat.flash_errors++;
+	return;
+    }
+
+    op.kind = OP_ERASE;
+    op.sector = n;
+    op.start = t;
+    op.end = t + erase_time(n, (regs.CR & CR_PSIZE) >> 8);
+    status |= FLASH_SR_BSY;
+    sim_stat.erases++;
+    if (sim.trace)
+	fprintf(stderr, "%10.3f ms  erase %d\n", t * 1000.0 / SIM_HZ, n);
+
+    if (++ops == sim.cut) {
+	sprintf(what, "erase of sector %d", n);
+	cut(what, sectors[n].addr, sectors[n].size, 1);
+    }
+}
+
+
+/**
+ *  ,        
+ * (  last),   ,    
+ */
+static void update(void)
+{
+    if (!(regs.SR & SR_MARK))	/* rc_w1 */
+	status &= ~(regs.SR & (SR_ERRORS | FLASH_SR_EOP));
+
+    if (regs.KEYR) {
+	if (keys == 0 && regs.KEYR == KEY1) {
+	    keys = 1;
+	} else if (keys == 1 && regs.KEYR == KEY2) {
+	    keys = 0;
+	    regs.CR &= ~FLASH_CR_LOCK;
+	} else {
+	    keys = -1;		/*   -   */
+	    regs.CR |= FLASH_CR_LOCK;
+	}
+	regs.KEYR = 0;
+    }
+
+    if (op.kind && sim_now() >= op.end)
+	finish();
+
+    if ((regs.CR & FLASH_CR_STRT) && op.kind == OP_NONE) {
+	if (regs.CR & FLASH_CR_LOCK) {
+	    regs.CR &= ~FLASH_CR_STRT;
+	    status |= FLASH_SR_WRPERR;
+	    sim_stat.flash_errors++;
+	} else {
+	    erase_start(last);
+	}
+    }
+    regs.SR = status | SR_MARK;
+}
+
+
+/* FLASH->: ~2   ,    BSY -     */
+FLASH_TypeDef *sim_flash_regs(void)
+{
+    sim_enter();
+    update();
+    if (op.kind)
+	sim_wait(SIM_SITE_FLASH, op.end);
+    else
+	sim_advance(2);
+    update();
+    last = sim_now();
+    sim_leave();
+    return &regs;
+}
+
+
+/**
+ *  size  v  flash   addr:   .
+ *    ,  
+ */
+void sim_flash_store(uint32_t addr, uint64_t v, int size)
+{
+    uint32_t psize = (regs.CR & CR_PSIZE) >> 8;
+    uint8_t *p, b;
+    char what[48];
+    int i, err = 1;
+
+    sim_enter();
+    update();
+    if (addr < FLASH_MEM || addr + size > FLASH_MEM + FLASH_MEM_SIZE) {
+	fprintf(stderr, "sim: flash store out of range: 0x%08X\n", addr);
+	abort();
+    }
+    if (op.kind) {
+	sim_advance(op.end - sim_now());
+	update();
+    }
+
+    if (regs.CR & FLASH_CR_LOCK) {
+	status |= FLASH_SR_WRPERR;
+    } else if (!(regs.CR & FLASH_CR_PG)) {
+	status |= FLASH_SR_PGSERR;
+    } else if (size != (1 << psize)) {
+	status |= FLASH_SR_PGPERR;
+    } else if (addr & (size - 1)) {
+	status |= FLASH_SR_PGAERR;
+    } else {
+	err = 0;
+	p = mem + addr - FLASH_MEM;
+	for (i = 0; i < size; i++) {
+	    b = (uint8_t) (v >> (8 * i));
+	    if ((p[i] & b) != b)
+		sim_stat.overprogram++;
+	    p[i] &= b;
+	}
+	op.kind = OP_PROGRAM;
+	op.start = sim_now();
+	op.end = op.start + SIM_US(sim.prog_us);
+	status |= FLASH_SR_BSY;
+	sim_stat.programs++;
+	if (++ops == sim.cut) {
+	    sprintf(what, "program of 0x%08X", addr);
+	    cut(what, addr, size, 0);
+	}
+    }
+    sim_stat.flash_errors += err;
+    regs.SR = status | SR_MARK;
+    sim_advance(1);
+    last = sim_now();
+    sim_leave();
+}
+
+
+/*     (  RAMFUNC) */
+int sim_flash_busy(void)
+{
+    return op.kind != OP_NONE && sim_now() < op.end;
+}
+
+
+/* : flash  ,    */
+void sim_flash_init(void)
+{
+    sim_map_file(sim.flash, FLASH_MEM, FLASH_MEM_SIZE, 0, 0xFF);
+    mem = sim_map_file(sim.flash, 0, FLASH_MEM_SIZE, 1, 0xFF);
+    regs.CR = FLASH_CR_LOCK;
+    regs.SR = status | SR_MARK;
+}
@@ -0,0 +1,125 @@
+/******************************************************************************
+ *  ,   : , PWR
+ * (backup SRAM), NVIC, .    ,  
+ *   backup SRAM
+ *****************************************************************************/
+#include <stdio.h>
+#include "simcore.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_conf.h"
+#include "stm32f4_discovery.h"
+
+
+/*  backup SRAM         */
+#define BRR_DELAY		SIM_US(50)
+
+uint32_t SystemCoreClock = SIM_HZ;	/* system_stm32f4xx.c  SystemInit() */
+static uint64_t brr_on;		/*   , 0 -  */
+
+
+void RCC_AHB1PeriphClockCmd(uint32_t p, FunctionalState s)
+{
+    (void) p;
+    (void) s;
+}
+
+
+void RCC_AHB2PeriphClockCmd(uint32_t p, FunctionalState s)
+{
+    (void) p;
+    (void) s;
+}
+
+
+void RCC_APB1PeriphClockCmd(uint32_t p, FunctionalState s)
+{
+    (void) p;
+    (void) s;
+}
+
+
+void RCC_APB2PeriphClockCmd(uint32_t p, FunctionalState s)
+{
+    (void) p;
+    (void) s;
+}
+
+
+void PWR_BackupAccessCmd(FunctionalState s)
+{
+    (void) s;
+}
+
+
+void PWR_BackupRegulatorCmd(FunctionalState s)
+{
+    sim_enter();
+    brr_on = (s == ENABLE) ? sim_now() + 1 : 0;
+    sim_leave();
+}
+
+
+FlagStatus PWR_GetFlagStatus(uint32_t flag)
+{
+    FlagStatus r = RESET;
+
+    sim_enter();
+    if (flag == PWR_FLAG_BRR && brr_on) {
+	sim_wait(SIM_SITE_PWR, brr_on + BRR_DELAY);
+	r = (sim_now() >= brr_on + BRR_DELAY) ? SET : RESET;
+    } else {
+	sim_advance(2);
+    }
+    sim_leave();
+    return r;
+}
+
+
+void NVIC_PriorityGroupConfig(uint32_t g)
+{
+    (void) g;
+}
+
+
+void NVIC_Init(NVIC_InitTypeDef * n)
+{
+    (void) n;
+}
+
+
+void NVIC_SetVectorTable(uint32_t tab, uint32_t off)
+{
+    (void) tab;
+    (void) off;
+}
+
+
+void EXTI_ClearITPendingBit(uint32_t line)
+{
+    (void) line;
+}
+
+
+void STM_EVAL_LEDInit(Led_TypeDef led)
+{
+    (void) led;
+}
+
+
+void STM_EVAL_LEDOn(Led_TypeDef led)
+{
+    (void) led;
+}
+
+
+void STM_EVAL_LEDOff(Led_TypeDef led)
+{
+    (void) led;
+}
+
+
+void STM_EVAL_LEDToggle(Led_TypeDef led)
+{
+    (void) led;
+    sim_stat.led_toggles++;
+}
@@ -0,0 +1,553 @@
+/******************************************************************************
+ *  SD  (SDHC)   SPI  SPI1  DMA2 ( 0 - ,
+ * 3 - ).  StdPeriph SPI, DMA  GPIO,  
+ * stm32_spi_sd.c,     .
+ *   ,  : R1    ,
+ *   -    ,   CMD18 -
+ * ,   - .     0xFF (0x00 -
+ * ).  -   
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "simcore.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_conf.h"
+
+
+#define BLOCK			512
+#define PIO_CYCLES		20	/*  SD_ReadByte()   SPI */
+
+#define MODE_NONE		0
+#define MODE_READ		1	/* CMD17/18:   */
+#define MODE_WRITE		2	/* CMD24/25:   */
+#define MODE_BUSY		3	/*    */
+
+
+static uint8_t *disk;
+static uint32_t nsect;
+
+static struct {
+    int cs;			/*  (CS ) */
+    int idle;			/*  idle  R1:   ACMD41 */
+    int acmd;			/*  CMD55 */
+    int polls;			/*  ACMD41   idle */
+    uint8_t cmd[6];
+    int ncmd;
+    uint8_t out[BLOCK + 8];	/*     */
+    int out_n, out_pos;
+    int block;			/*  out -   */
+    int mode, after;		/* MODE_x      BUSY */
+    int multi;
+    uint32_t sect;		/*   */
+    uint64_t ready;		/* READ:  , BUSY:  */
+    int token;			/* WRITE:   */
+    uint8_t wbuf[BLOCK + 2];
+    int wn;
+} card;
+
+/* SPI1 */
+static struct {
+    uint32_t byte;		/*     */
+    uint16_t rx;		/*   (DR) */
+    uint16_t dmareq;		/* SPI_I2S_DMAReq_x */
+} spi = { 16 * 2 };
+
+/*  DMA:  ,    */
+typedef struct {
+    DMA_Stream_TypeDef *id;
+    uint32_t mem, count, dir, minc;
+    int on;
+    int tc;			/*  :  TC   end */
+    uint64_t end;
+} stream_t;
+static stream_t streams[2];
+
+
+/*      */
+static void out(uint8_t b)
+{
+    card.out[card.out_n++] = b;
+}
+
+
+static void r1(uint8_t r)
+{
+    out(r);
+}
+
+
+/*      t */
+static void command(uint64_t t)
+{
+    uint8_t c = card.cmd[0] & 0x3F, csd[16];
+    uint32_t arg = ((uint32_t) card.cmd[1] << 24) | (card.cmd[2] << 16) | (card.cmd[3] << 8) | card.cmd[4];
+    int i;
+
+    sim_stat.cmds++;
+    if (sim.trace)
+	fprintf(stderr, "%10.3f ms  CMD%d %u\n", t * 1000.0 / SIM_HZ, c, arg);
+    card.out_n = card.out_pos = 0;
+    card.block = 0;
+    out(0xFF);			/* Ncr */
+
+    if (card.acmd) {
+	card.acmd = 0;
+	switch (c) {
+	case 41:
+	    if (card.polls > 0)
+		card.polls--;
+	    else
+		card.idle = 0;
+	    r1(card.idle);
+	    return;
+	case 23:
+	    r1(card.idle);
+	    return;
+	}
+    }
+
+    if (card.idle && c != 0 && c != 8 && c != 55 && c != 58 && c != 41) {
+	r1(0x05);
+	return;
+    }
+
+    switch (c) {
+    case 0:
+	card.idle = 1;
+	card.polls = 1;
+	card.mode = MODE_NONE;
+	r1(0x01);
+	break;
+    case 8:
+	r1(card.idle);
+	out(0x00);
+	out(0x00);
+	out((arg >> 8) & 0x0F);
+	out(arg & 0xFF);
+	break;
+    case 55:
+	card.acmd = 1;
+	r1(card.idle);
+	break;
+    case 58:
+	r1(card.idle);
+	out(card.idle ? 0x00 : 0xC0);	/* , SDHC */
+	out(0xFF);
+	out(0x80);
+	out(0x00);
+	break;
+    case 16:
+	r1(arg == BLOCK ? 0x00 : 0x40);
+	break;
+    case 9:			/* CSD 2.0 */
+	memset(csd, 0, sizeof(csd));
+	csd[0] = 0x40;
+	i = nsect / 1024 - 1;
+	csd[7] = (i >> 16) & 0x3F;
+	csd[8] = i >> 8;
+	csd[9] = i;
+	r1(0x00);
+	out(0xFF);
+	out(0xFE);
+	for (i = 0; i < 16; i++)
+	    out(csd[i]);
+	out(0xFF);
+	out(0xFF);
+	break;
+    case 12:
+	card.mode = MODE_BUSY;
+	card.after = MODE_NONE;
+	card.ready = t + SIM_US(1);
+	r1(0x00);
+	break;
+    case 17:
+    case 18:
+	if (arg >= nsect) {
+	    r1(0x40);
+	    break;
+	}
+	r1(0x00);
+	card.mode = MODE_READ;
+	card.multi = (c == 18);
+	card.sect = arg;
+	card.ready = t + SIM_US(sim.card_access_us);
+	break;
+    case 24:
+    case 25:
+	if (arg >= nsect) {
+	    r1(0x40);
+	    break;
+	}
+	r1(0x00);
+	card.mode = MODE_WRITE;
+	card.multi = (c == 25);
+	card.sect = arg;
+	card.token = 0;
+	break;
+    default:
+	r1(0x04);
+    }
+}
+
+
+/*      */
+static void write_byte(uint8_t in, uint64_t t)
+{
+    if (!card.token) {
+	if (in == 0xFE || (card.multi && in == 0xFC)) {
+	    card.token = 1;
+	    card.wn = 0;
+	} else if (card.multi && in == 0xFD) {
+	    card.mode = MODE_BUSY;
+	    card.after = MODE_NONE;
+	    card.ready = t + SIM_US(sim.card_write_us);
+	}
+	return;
+    }
+
+    card.wbuf[card.wn++] = in;
+    if (card.wn < BLOCK + 2)
+	return;
+
+    if (card.sect < nsect) {
+	memcpy(disk + (size_t) card.sect * BLOCK, card.wbuf, BLOCK);
+	sim_stat.blocks_written++;
+    }
+    card.sect++;
+    card.token = 0;
+    card.out_n = card.out_pos = 0;
+    out(0x05);			/* Data accepted */
+    card.mode = MODE_BUSY;
+    card.after = card.multi ? MODE_WRITE : MODE_NONE;
+    card.ready = t + SIM_US(sim.card_write_us);
+}
+
+
+/*       t: in ,   */
+static uint8_t xchg(uint8_t in, uint64_t t)
+{
+    uint8_t o = 0xFF;
+
+    if (!card.cs || disk == NULL)
+	return 0xFF;
+
+    if (card.out_pos < card.out_n) {
+	o = card.out[card.out_pos++];
+	if (card.out_pos == card.out_n && card.block) {
+	    /*    */
+	    card.block = 0;
+	    card.out_n = card.out_pos = 0;
+	    if (card.multi)
+		card.ready = t + SIM_US(sim.card_gap_us);
+	    else
+		card.mode = MODE_NONE;
+	}
+    } else if (card.mode == MODE_READ && t >= card.ready) {
+	card.out_n = card.out_pos = 0;
+	if (sim.card_fail && card.sect + 1 == sim.card_fail) {
+	    out(0x01);		/* Error token:   */
+	    card.mode = MODE_NONE;
+	} else {
+	    out(0xFE);
+	    memcpy(card.out + 1, disk + (size_t) card.sect * BLOCK, BLOCK);
+	    card.out_n += BLOCK;
+	    out(0xFF);
+	    out(0xFF);
+	    card.block = 1;
+	    sim_stat.blocks_read++;
+	}
+	card.sect++;
+	o = card.out[card.out_pos++];
+    } else if (card.mode == MODE_BUSY) {
+	if (t >= card.ready)
+	    card.mode = card.after;
+	else
+	    o = 0x00;
+    }
+
+    if (card.mode == MODE_WRITE) {
+	write_byte(in, t);
+    } else if (card.ncmd > 0 || (in & 0xC0) == 0x40) {
+	card.cmd[card.ncmd++] = in;
+	if (card.ncmd == 6) {
+	    card.ncmd = 0;
+	    command(t);
+	}
+    }
+    return o;
+}
+
+
+/* CS */
+static void select_card(int on)
+{
+    if (card.cs != on)
+	card.ncmd = 0;
+    card.cs = on;
+}
+
+
+/*    sim.disk;   -    */
+void sim_sd_init(void)
+{
+    struct stat st;
+    int fd;
+
+    memset(&card, 0, sizeof(card));
+    fd = open(sim.disk, O_RDWR);
+    if (fd < 0 && errno == ENOENT)
+	return;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+	perror(sim.disk);
+	exit(2);
+    }
+    disk = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (disk == MAP_FAILED) {
+	perror(sim.disk);
+	exit(2);
+    }
+    close(fd);
+    nsect = st.st_size / BLOCK;
+}
+
+
+/*------------------------------- SPI ---------------------------------------*/
+
+void SPI_StructInit(SPI_InitTypeDef * s)
+{
+    memset(s, 0, sizeof(*s));
+    s->SPI_CRCPolynomial = 7;
+}
+
+
+/*  SPI1: APB2 84  / ,  - 8  SPI */
+void SPI_Init(SPI_TypeDef * SPIx, SPI_InitTypeDef * s)
+{
+    uint32_t div = 2 << (s->SPI_BaudRatePrescaler >> 3);
+
+    (void) SPIx;
+    if (sim.spi_div)
+	div = sim.spi_div;
+    spi.byte = 8 * 2 * div;
+}
+
+
+void SPI_Cmd(SPI_TypeDef * SPIx, FunctionalState state)
+{
+    (void) SPIx;
+    (void) state;
+}
+
+
+void SPI_I2S_SendData(SPI_TypeDef * SPIx, uint16_t data)
+{
+    (void) SPIx;
+    sim_enter();
+    spi.rx = xchg((uint8_t) data, sim_now());
+    sim_stat.spi_bytes++;
+    sim_advance(spi.byte + PIO_CYCLES);
+    sim_leave();
+}
+
+
+uint16_t SPI_I2S_ReceiveData(SPI_TypeDef * SPIx)
+{
+    (void) SPIx;
+    return spi.rx;
+}
+
+
+FlagStatus SPI_I2S_GetFlagStatus(SPI_TypeDef * SPIx, uint16_t flag)
+{
+    (void) SPIx;
+    (void) flag;
+    return SET;			/*     SendData() */
+}
+
+
+/*------------------------------- DMA ---------------------------------------*/
+
+static stream_t *stream(DMA_Stream_TypeDef * id)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+	if (streams[i].id == id || streams[i].id == NULL) {
+	    streams[i].id = id;
+	    return &streams[i];
+	}
+    }
+    fprintf(stderr, "sim: too many DMA streams\n");
+    abort();
+}
+
+
+/**
+ *      SPI  DMA - .  i
+ *    start + i * byte;   ,
+ *   TC    
+ */
+static void dma_start(void)
+{
+    stream_t *rx = NULL, *tx = NULL;
+    uint64_t t;
+    uint8_t *dst, b;
+    uint32_t i;
+
+    for (i = 0; i < 2; i++) {
+	if (streams[i].on && streams[i].dir == DMA_DIR_PeripheralToMemory)
+	    rx = &streams[i];
+	if (streams[i].on && streams[i].dir == DMA_DIR_MemoryToPeripheral)
+	    tx = &streams[i];
+    }
+    if (rx == NULL || tx == NULL || (spi.dmareq & 3) != 3 || rx->tc || rx->end)
+	return;
+
+    t = sim_now();
+    dst = (uint8_t *) (uintptr_t) rx->mem;
+    for (i = 0; i < rx->count; i++, t += spi.byte) {
+	b = xchg(*(uint8_t *) (uintptr_t) (tx->mem + (tx->minc ? i : 0)), t);
+	if (b == 0xFF)
+	    sim_stat.dma_idle++;
+	if (rx->minc)
+	    dst[i] = b;
+	else
+	    dst[0] = b;
+    }
+    sim_stat.dma_bytes += rx->count;
+    rx->end = tx->end = t;
+}
+
+
+void DMA_DeInit(DMA_Stream_TypeDef * id)
+{
+    stream_t *s = stream(id);
+
+    memset(s, 0, sizeof(*s));
+    s->id = id;
+}
+
+
+void DMA_StructInit(DMA_InitTypeDef * d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+
+void DMA_Init(DMA_Stream_TypeDef * id, DMA_InitTypeDef * d)
+{
+    stream_t *s = stream(id);
+
+    s->mem = d->DMA_Memory0BaseAddr;
+    s->count = d->DMA_BufferSize;
+    s->dir = d->DMA_DIR;
+    s->minc = (d->DMA_MemoryInc == DMA_MemoryInc_Enable);
+    s->tc = 0;
+    s->end = 0;
+}
+
+
+void DMA_Cmd(DMA_Stream_TypeDef * id, FunctionalState state)
+{
+    stream_t *s = stream(id);
+
+    sim_enter();
+    s->on = (state == ENABLE);
+    if (s->on)
+	dma_start();
+    sim_advance(2);
+    sim_leave();
+}
+
+
+void SPI_I2S_DMACmd(SPI_TypeDef * SPIx, uint16_t req, FunctionalState state)
+{
+    (void) SPIx;
+    sim_enter();
+    if (state == ENABLE)
+	spi.dmareq |= req;
+    else
+	spi.dmareq &= ~req;
+    if (state == ENABLE)
+	dma_start();
+    sim_advance(2);
+    sim_leave();
+}
+
+
+/*  -  TC:     */
+FlagStatus DMA_GetFlagStatus(DMA_Stream_TypeDef * id, uint32_t flag)
+{
+    stream_t *s = stream(id);
+    FlagStatus r;
+
+    (void) flag;
+    if (!s->end && !s->tc) {
+	fprintf(stderr, "sim: DMA flag polled with no transfer\n");
+	abort();
+    }
+    sim_enter();
+    if (!s->tc)
+	sim_wait(SIM_SITE_DMA, s->end);
+    if (sim_now() >= s->end)
+	s->tc = 1;
+    r = s->tc ? SET : RESET;
+    sim_leave();
+    return r;
+}
+
+
+void DMA_ClearFlag(DMA_Stream_TypeDef * id, uint32_t flag)
+{
+    stream_t *s = stream(id);
+
+    (void) flag;
+    if (s->tc) {
+	s->tc = 0;
+	s->end = 0;
+    }
+}
+
+
+/*------------------------------- GPIO --------------------------------------*/
+
+void GPIO_Init(GPIO_TypeDef * port, GPIO_InitTypeDef * g)
+{
+    (void) port;
+    (void) g;
+}
+
+
+void GPIO_StructInit(GPIO_InitTypeDef * g)
+{
+    memset(g, 0, sizeof(*g));
+}
+
+
+void GPIO_PinAFConfig(GPIO_TypeDef * port, uint16_t src, uint8_t af)
+{
+    (void) port;
+    (void) src;
+    (void) af;
+}
+
+
+/* CS  - PA4,  -  */
+void GPIO_SetBits(GPIO_TypeDef * port, uint16_t pins)
+{
+    if (port == GPIOA && (pins & GPIO_Pin_4))
+	select_card(0);
+}
+
+
+void GPIO_ResetBits(GPIO_TypeDef * port, uint16_t pins)
+{
+    if (port == GPIOA && (pins & GPIO_Pin_4))
+	select_card(1);
+}
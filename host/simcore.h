@@ -0,0 +1,80 @@
+/******************************************************************************
+ *      PC:     
+ * (168 ), flash, SD   SPI1  DMA, SysTick
+ *****************************************************************************/
+#ifndef _SIMCORE_H
+#define _SIMCORE_H
+
+#include <stdint.h>
+
+
+#define SIM_HZ			168000000ULL
+#define SIM_US(x)		((uint64_t) (x) * (SIM_HZ / 1000000))
+#define SIM_MS(x)		((uint64_t) (x) * (SIM_HZ / 1000))
+
+/*  ,    (sim.cut) */
+#define SIM_EXIT_CUT		3
+
+/*       (sim_wait) */
+#define SIM_SITE_FLASH		1
+#define SIM_SITE_DMA		2
+#define SIM_SITE_NOP		3
+#define SIM_SITE_PWR		4
+
+
+/*  ,   loader (sim.c) */
+typedef struct {
+    const char *disk;		/*   */
+    const char *flash;		/*  flash, 1;   -  */
+    const char *backup;		/* Backup SRAM, 4 */
+    int vbat;			/* 0 - VBAT : backup SRAM    */
+    double cpu;			/*        PC, 0 -   */
+    uint32_t spi_div;		/*  SPI   , 0 -   */
+    uint32_t card_access_us;	/* CMD17/18:    */
+    uint32_t card_gap_us;	/* CMD18:   */
+    uint32_t card_write_us;	/*     */
+    uint32_t card_fail;		/*       + 1, 0 -  */
+    uint32_t prog_us;		/*   (x32) */
+    uint32_t erase_ms[3];	/*  16, 64, 128 (x32) */
+    uint32_t cut;		/*      flash ( 1), 0 -  */
+    int trace;			/*     flash -  stderr */
+} sim_param_t;
+
+/*    */
+typedef struct {
+    uint32_t erases;		/*   */
+    uint32_t programs;		/*   flash (, ) */
+    uint32_t overprogram;	/*     */
+    uint32_t flash_errors;	/*   PG,   ,  ,  LOCK */
+    uint64_t flash_busy;	/*   BSY */
+    uint32_t cmds;		/*   */
+    uint32_t blocks_read;	/*    */
+    uint32_t blocks_written;	/*     */
+    uint64_t spi_bytes;		/*   SPI  */
+    uint64_t dma_bytes;		/* ...   DMA */
+    uint64_t dma_idle;		/*   0xFF   (  ) */
+    uint32_t ramfunc_calls;	/*    flash  BSY (sim_ramcheck) */
+    uint32_t led_toggles;	/*   */
+} sim_stat_t;
+
+
+extern sim_param_t sim;
+extern sim_stat_t sim_stat;
+
+void sim_init(void);
+void sim_done(void);
+
+uint64_t sim_now(void);
+void sim_enter(void);
+void sim_leave(void);
+void sim_advance(uint64_t);
+void sim_wait(int, uint64_t);
+void sim_power_cut(const char *) __attribute__ ((noreturn));
+
+uint8_t *sim_map_file(const char *, uint32_t, uint32_t, int, uint8_t);
+
+void sim_flash_init(void);
+int sim_flash_busy(void);
+void sim_sd_init(void);
+
+#endif /* simcore.h */
@@ -0,0 +1,9 @@
+# Ключи тестовой сборки loader_signed. Закрытый ключ Ed25519 - RFC 8032,
+# 7.1 TEST 1, ключ AES-128 - FIPS-197, приложение A.1. Те же ключи
+# знает tools/mkimage.py (ключи --sign test, --aes test)
+TEST_PUBLIC_KEY	= { 0xD7, 0x5A, 0x98, 0x01, 0x82, 0xB1, 0x0A, 0xB7, \
+		    0xD5, 0x4B, 0xFE, 0xD3, 0xC9, 0x64, 0x07, 0x3A, \
+		    0x0E, 0xE1, 0x72, 0xF3, 0xDA, 0xA6, 0x23, 0x25, \
+		    0xAF, 0x02, 0x1A, 0x68, 0xF7, 0x07, 0x51, 0x1A }
+TEST_AES_KEY	= { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, \
+		    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C }
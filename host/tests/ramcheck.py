@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Код RAMFUNC не должен трогать flash: ни звать функции из .text, ни читать
+константы из .rodata (у IAR - предупреждения Ta022/Ta023).
+
+  ramcheck.py obj/loader/fw/*.o ...
+
+Смотрит перемещения в секции ramfunc объектов прошивки. Можно: другой код
+ramfunc, данные в ОЗУ (.data, .bss) и модель платы (sim_*: на плате это
+регистры). Остальное - ошибка.
+"""
+
+import re
+import subprocess
+import sys
+
+RAM_SECTIONS = ('ramfunc', '.data', '.bss', '*COM*')
+HW_MODEL = ('sim_', '__cyg_profile_func_')
+
+SYM_RE = re.compile(r'^[0-9a-f]+\s.{7}\s(\S+)\s+[0-9a-f]+\s+(\S+)$')
+REL_RE = re.compile(r'^\s*([0-9a-f]+):\s+R_\S+\s+([^+\s]+?)(?:[+-]0x[0-9a-f]+)?$')
+FUNC_RE = re.compile(r'^[0-9a-f]+ <(\S+)>:$')
+
+
+def objdump(*args):
+    return subprocess.run(['objdump'] + list(args), stdout=subprocess.PIPE,
+                          universal_newlines=True, check=True).stdout
+
+
+def in_ram(section):
+    return any(section == s or section.startswith(s + '.') for s in RAM_SECTIONS)
+
+
+def main(objs):
+    where = {}                  # Символ -> секция, где он определен
+    for o in objs:
+        for line in objdump('-t', o).splitlines():
+            m = SYM_RE.match(line)
+            if m and m.group(1) != '*UND*':
+                where.setdefault(m.group(2), m.group(1))
+
+    bad = 0
+    for o in objs:
+        if ' ramfunc ' not in objdump('-h', o):
+            continue
+        func = None
+        for line in objdump('-dr', '-j', 'ramfunc', o).splitlines():
+            m = FUNC_RE.match(line)
+            if m:
+                func = m.group(1)
+                continue
+            m = REL_RE.match(line)
+            if not m:
+                continue
+            sym = m.group(2)
+            if sym.startswith(HW_MODEL):
+                continue
+            sec = sym if sym.startswith('.') or sym == 'ramfunc' else where.get(sym, 'libc')
+            if not in_ram(sec):
+                print('%s: %s: %s (%s)' % (o, func, sym, sec))
+                bad += 1
+    return 1 if bad else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""A/B (loader_ab): сырой образ идет в слот, под который собран,
+и только если этот слот неактивен"""
+
+from simtest import Board, app, check
+
+SLOT_A = 0x08020000
+SLOT_B = 0x08080000
+
+b = Board('ab', loader='loader_ab')
+
+fw_b = app(100000, addr=SLOT_B, seed=31)
+b.put('loader.bin', fw_b)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(SLOT_B, len(fw_b)) == fw_b, 'built for B - written to B')
+check(r['boot'] == SLOT_B, 'B boots')
+
+fw_b2 = app(100000, addr=SLOT_B, seed=32)
+b.put('loader.bin', fw_b2)
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'built for the active slot - rejected')
+check(b.flash_read(SLOT_B, len(fw_b)) == fw_b and r['boot'] == SLOT_B, 'running copy intact')
+
+fw_a = app(100000, addr=SLOT_A, seed=33)
+b.put('loader.bin', fw_a)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(SLOT_A, len(fw_a)) == fw_a, 'built for A - written to A')
+check(r['boot'] == SLOT_A, 'A boots')
+
+noise = bytes(app(4096, seed=34)[8:]) + b'\x00' * 8
+b.put('loader.bin', noise)
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'not an application - rejected')
+
+
+# Обрыв питания на каждом стирании и по ходу записи в неактивный слот:
+# загружается старый слот, целый; переключение - только после записи.
+# В B перед каждым обновлением - прошлая прошивка
+FAST = ('-e', '1,1,1', '-p', '0')
+fw_b3 = app(300000, addr=SLOT_B, seed=35)
+
+
+def old_b():
+    b.flash_write(SLOT_B, b'\xFF' * 0x60000)
+    b.flash_write(SLOT_B, fw_b)
+    b.put('loader.bin', fw_b3)
+
+
+old_b()
+r = b.run(*FAST)
+total = r['sim_erases'] + r['sim_programs']
+check(r['result'] == 1 and r['boot'] == SLOT_B and r['sim_erases'] == 3,
+      'B updated: 3 sectors, %d flash operations' % total)
+b.put('loader.bin', fw_a)
+r = b.run(*FAST)
+check(r['result'] == 1 and r['boot'] == SLOT_A and r['sim_erases'] == 0, 'A unchanged - only switched')
+
+points = [1, 2, 3, 4, 5] + [total * k // 13 for k in range(1, 13)] + [total - 1, total]
+for k in points:
+    old_b()
+    b.run('-k', k, *FAST, expect_cut=True)
+    r = b.run(*FAST, card=False)
+    if r['boot'] != SLOT_A or b.flash_read(SLOT_A, len(fw_a)) != fw_a:
+        raise AssertionError('A lost after a cut at op %d of %d' % (k, total))
+    r = b.run(*FAST)
+    if r['result'] != 1 or r['boot'] != SLOT_B or b.flash_read(SLOT_B, len(fw_b3)) != fw_b3:
+        raise AssertionError('B not finished after a cut at op %d of %d' % (k, total))
+    b.put('loader.bin', fw_a)
+    b.run(*FAST)
+check(True, 'cut at %d points: A boots intact, B finished on the next power-up' % len(points))
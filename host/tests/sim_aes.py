@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""Зашифрованные образы (IMAGE_FLAG_AES): AES-128-CTR тестовым ключом
+loader_signed, расшифровка потоком между картой и flash"""
+
+import shutil
+import subprocess
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build, TEST_AES_KEY, TEST_SIGN_KEY
+
+FAST = ('-e', '1,1,1', '-p', '0')
+IV = bytes(range(0xF0, 0x100))
+
+b = Board('aes', loader='loader_signed')
+fw = app(60000, seed=91)
+img = build(fw, APP_ADDRESS, sign=TEST_SIGN_KEY, aes=TEST_AES_KEY, iv=IV)
+check(fw[4096:4160] not in img, 'no plaintext in the file')
+
+# Шифр тот же, что у OpenSSL
+if shutil.which('openssl'):
+    ref = subprocess.run(['openssl', 'enc', '-aes-128-ctr', '-nosalt', '-K', TEST_AES_KEY.hex(),
+                          '-iv', IV.hex()], input=fw, stdout=subprocess.PIPE, check=True).stdout
+    check(img[512:] == ref, 'data as from openssl enc -aes-128-ctr')
+
+b.put('loader.bin', img)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw and r['verify_errors'] == 0,
+      'encrypted image written')
+
+# Шифруется и сжатое
+fw2 = bytes(fw[:30000]) * 2
+b.put('loader.bin', build(fw2, APP_ADDRESS, sign=TEST_SIGN_KEY, aes=TEST_AES_KEY, hs=(10, 5)))
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw2)) == fw2, 'compressed and encrypted')
+
+# Чужой ключ: подпись цела, но данные не сходятся - до стирания
+fw3 = app(60000, seed=92)
+b.put('loader.bin', build(fw3, APP_ADDRESS, sign=TEST_SIGN_KEY, aes=bytes(16)))
+r = b.run(*FAST)
+check(r['result'] != 1 and r['sim_erases'] == 0 and b.flash_read(APP_ADDRESS, len(fw2)) == fw2,
+      'another AES key - rejected, flash untouched')
+
+# Загрузчик без ключа AES шифрованного не пишет
+b = Board('aes_plain')
+b.put('loader.bin', img)
+r = b.run(*FAST)
+check(r['result'] != 1 and r['sim_erases'] == 0, 'no key in the plain loader - rejected')
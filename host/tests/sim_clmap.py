@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Карта кластеров файла образа (UPDATE_CLMT_SIZE): по ней чтение идет
+без обращений к FAT; файл из слишком многих кусков читается по FAT"""
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+FAST = ('-e', '1,1,1', '-p', '0')
+
+fw = app(200000, seed=101)
+img = build(fw, APP_ADDRESS)
+mb = len(img) / (1 << 20)
+
+
+def board(kind):
+    """Файл одним куском, в пять кусков (в дыры от удаленных файлов)
+    или кластер через кластер"""
+    b = Board('clmap')
+    if kind == 'few':
+        for i in range(4):
+            b.put('pad%d.bin' % i, bytes(4096))
+            b.put('hole%d.bin' % i, bytes(16384))
+        b.put('pad9.bin', bytes(4096))
+        for i in range(4):
+            b.remove('hole%d.bin' % i)
+    b.put('loader.bin', img, frag=1 if kind == 'many' else 0)
+    r = b.run(*FAST)
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, kind + ': written')
+    print('  %-10s %2d fragments, %d unmapped: %4.0f driver calls/MB, %d blocks, %d streams' %
+          (kind, r['fragments'], r['unmapped'], r['sd_reads'] / mb, r['sd_blocks'],
+           r['sd_streams']))
+    return r
+
+
+one = board('contiguous')
+check(one['fragments'] == 1 and one['unmapped'] == 0, 'contiguous file - one fragment')
+
+few = board('few')
+check(few['fragments'] == 5 and few['unmapped'] == 0, 'five fragments mapped')
+check(few['sd_blocks'] <= one['sd_blocks'], 'no FAT blocks read during the transfer')
+check(few['sd_streams'] <= one['sd_streams'] + few['fragments'],
+      'card streams break only between fragments')
+
+many = board('many')
+check(many['unmapped'] == 1 and many['fragments'] == 0, 'too many fragments - read by FAT')
+check(many['sd_blocks'] > one['sd_blocks'], 'FAT blocks read along the way')
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Образ, сжатый heatshrink (IMAGE_FLAG_HS): распаковка потоком в окне
+2^w байт, с разными параметрами сжатия"""
+
+import random
+import struct
+
+from simtest import Board, check, APP_ADDRESS
+from mkimage import build, header, crc32_stm, FLAG_HS
+
+
+def firmware(size, seed):
+    """Похоже на код: куски из небольшого набора, иногда с правкой"""
+    r = random.Random(seed)
+    snippets = [bytes(r.getrandbits(8) for _ in range(r.randrange(8, 24))) for _ in range(12)]
+    body = bytearray(struct.pack('<II', 0x20020000, APP_ADDRESS + 0x101))
+    while len(body) < size:
+        body += r.choice(snippets)
+        if r.random() < 0.3:
+            body += struct.pack('<I', r.getrandbits(32))
+    return bytes(body[:size])
+
+
+b = Board('compress')
+fw = firmware(120000, 51)
+
+for w, l in ((8, 4), (10, 5), (4, 3)):
+    img = build(fw, APP_ADDRESS, sha=True, hs=(w, l))
+    b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+    b.put('loader.bin', img)
+    r = b.run('-e', '1,1,1')
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+          '-w %d -l %d: %d bytes from a %d byte file' % (w, l, len(fw), len(img)))
+    check(r['verify_errors'] == 0, '-w %d -l %d: verified' % (w, l))
+    # Окно 16 байт короче повторяющихся кусков: там сжатие не выигрывает
+    if w >= 8:
+        check(len(img) < len(fw) // 2, '-w %d -l %d: file is smaller' % (w, l))
+
+# Обрыв: сжатое проходится с начала, записанные секторы не переписываются
+img = build(fw, APP_ADDRESS, hs=(8, 4))
+b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+b.put('loader.bin', img)
+b.run('-e', '1,1,1', '-k', 20000, expect_cut=True)
+r = b.run('-e', '1,1,1')
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'finished after a cut')
+check(r['skipped'] > 0, 'sectors written before the cut skipped (%d)' % r['skipped'])
+
+# Окно больше, чем есть ОЗУ (HS_WINDOW_MAX), - отвергается до стирания
+data = build(fw, APP_ADDRESS, hs=(8, 4))[512:]
+h = header(len(fw), APP_ADDRESS, APP_ADDRESS, crc32_stm(fw), FLAG_HS | 11 << 8 | 4 << 12, 1)
+b.put('loader.bin', h + b'\xFF' * (512 - len(h)) + data)
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'window 2^11 rejected, flash untouched')
+
+# Тот же образ несжатым и сжатым: блоков с карты и время обновления по
+# модели с быстрой flash - чтобы было видно карту. SPI драйвера (-s 0)
+# и медленный (-s 64, 1.3 МГц). В time_ms - и 250 мс индикации в конце.
+# С временем кода на PC (-c 1, медиана трех включений) - для сведения
+res = {}
+for div in (0, 64):
+    for name, hs in (('raw', None), ('heatshrink', (8, 4))):
+        img = build(fw, APP_ADDRESS, sha=True, hs=hs)
+        times = []
+        for opts in ((), ('-c', 1), ('-c', 1), ('-c', 1)):
+            b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+            b.put('loader.bin', img)
+            r = b.run('-e', '1,1,1', '-p', '0', '-s', div, *opts)
+            check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+                  '-s %d %s: written' % (div, name))
+            if opts:
+                times.append(r['time_ms'])
+            else:
+                res[div, name] = r
+        print('  -s %-2d %-10s %6d byte file: %.1f ms, %d card blocks; with CPU time %.1f ms' %
+              (div, name, len(img), res[div, name]['time_ms'], res[div, name]['sim_blocks_read'],
+               sorted(times)[1]))
+    raw, hs = res[div, 'raw'], res[div, 'heatshrink']
+    check(hs['sim_blocks_read'] * 4 < raw['sim_blocks_read'] * 3,
+          '-s %d: fewer card blocks read compressed' % div)
+    check(hs['time_ms'] < raw['time_ms'], '-s %d: compressed update is faster' % div)
+check(res[64, 'heatshrink']['time_ms'] < res[64, 'raw']['time_ms'] * 0.85,
+      'slow card: compressed update at least 15% faster')
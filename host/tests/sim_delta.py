@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+"""Патч к прошивке во flash: крупные секторы копируются в запасной
+сектор (UPDATE_SPARE_SECTOR), и никакой образ его не занимает"""
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+SPARE = 0x080E0000              # Сектор 11
+
+b = Board('delta')
+old = app(300000, seed=11)
+new = bytearray(old)
+for i in range(0, len(new), 4096):
+    new[i + 100] ^= 0x5A
+new = bytes(new) + app(20000, seed=12)
+
+b.flash_write(APP_ADDRESS, old)
+b.put('loader.bin', build(new, APP_ADDRESS, base=old))
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(new)) == new, 'patch applied')
+check(b.flash_read(SPARE, 0x20000) != b'\xFF' * 0x20000, '128K sectors copied to the spare one')
+
+b.put('loader.bin', build(app(300000, seed=15), APP_ADDRESS, base=old))
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'patch to another firmware - flash untouched')
+
+# Запасной сектор не отдается ни образу, ни строке манифеста
+b.flash_write(APP_ADDRESS, b'\xFF' * len(new))
+b.put('loader.bin', app(0x100000 - 0x4000 - 0x8000, seed=13))
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'raw image over the spare sector rejected')
+
+data = app(1024, seed=14)
+b.put('calib.bin', data)
+b.put('loader.lst', b'calib.bin 0x%08X\n' % SPARE)
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'manifest entry in the spare sector rejected')
+b.put('loader.lst', b'calib.bin 0x%08X\n' % 0x080C0000)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(0x080C0000, len(data)) == data, 'sector 10 still usable')
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Подсказки места файлов в корне (backup SRAM): у каждого имени своя,
+манифест и образы из него находятся чтением одного сектора каталога"""
+
+import struct
+
+from simtest import Board, app, check, APP_ADDRESS
+
+DATA_ADDRESS = 0x080C0000
+FAST = ('-e', '1,1,1', '-p', '0')
+
+b = Board('dirhint')
+for i in range(300):
+    b.put('log%05d.txt' % i, b'x' * 10)
+
+calib = app(3000, seed=42)
+
+
+def card(seed):
+    b.put('loader.lst', b'app.bin 0x%08X\ncalib.bin 0x%08X\n' % (APP_ADDRESS, DATA_ADDRESS))
+    b.put('app.bin', app(20000, seed=seed))
+    b.put('calib.bin', calib)
+
+
+card(41)
+r = b.run()
+check(r['result'] == 1 and r['dir_hits'] == 0, 'first boot: directory scanned')
+cold = r['sim_blocks_read']
+
+# Новые файлы ложатся в те же записи каталога
+card(43)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, 20000) == app(20000, seed=43), 'second update written')
+check(r['dir_hits'] == 3, 'manifest and both images found by their hints (%d)' % r['dir_hits'])
+print('  card blocks: %d cold, %d with hints' % (cold, r['sim_blocks_read']))
+
+# Без манифеста - свои подсказки у loader.bin, манифестные не тронуты
+b.put('loader.bin', app(20000, seed=44))
+r = b.run()
+check(r['result'] == 1 and r['dir_hits'] == 1, 'loader.bin: scanned once, reopened by its hint')
+card(45)
+r = b.run()
+check(r['result'] == 1 and r['dir_hits'] == 3, 'manifest hints survived the single-file boot')
+
+# Перед манифестом лег чужой файл, записи сдвинулись: по подсказкам -
+# чужие имена, все три находятся поиском, подсказки переписаны
+b.put('pad.txt', b'pad')
+card(46)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, 20000) == app(20000, seed=46),
+      'entries moved: found by scanning, written')
+check(r['dir_hits'] == 0, 'stale hints not taken (%d)' % r['dir_hits'])
+card(47)
+r = b.run()
+check(r['result'] == 1 and r['dir_hits'] == 3, 'new places remembered')
+
+# calib.bin не положили: на месте его подсказки - удаленная запись
+b.put('loader.lst', b'app.bin 0x%08X\ncalib.bin 0x%08X\n' % (APP_ADDRESS, DATA_ADDRESS))
+b.put('app.bin', app(20000, seed=48))
+r = b.run()
+check(r['result'] != 1 and b.flash_read(APP_ADDRESS, 20000) == app(20000, seed=47),
+      'deleted entry not opened by its hint, nothing written')
+b.put('calib.bin', calib)
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, 20000) == app(20000, seed=48),
+      'written once calib.bin is there')
+
+# Другой том (серийный номер) с теми же записями: подсказки не для него
+card(49)
+with open(b.disk, 'r+b') as f:
+    f.seek(446 + 8)
+    at = struct.unpack('<I', f.read(4))[0] * 512 + 39
+    f.seek(at)
+    vsn = struct.unpack('<I', f.read(4))[0]
+    f.seek(at)
+    f.write(struct.pack('<I', vsn ^ 0x5A5A5A5A))
+r = b.run()
+check(r['result'] == 1 and r['dir_hits'] == 0 and
+      b.flash_read(APP_ADDRESS, 20000) == app(20000, seed=49), 'other volume: directory scanned')
+
+# Размер корня: loader.bin последним, за n чужими файлами. Одна и та же
+# карта с подсказкой и без нее (-V: backup SRAM очищена при включении).
+# Без нее поиском находится только первое открытие, повторное - уже по
+# только что записанной подсказке; время - вместе с записью образа
+fw = app(4000, seed=50)
+for n in (10, 100, 500):
+    d = Board('dirhint_%d' % n)
+    for i in range(n):
+        d.put('log%05d.txt' % i, b'x' * 10)
+    d.put('loader.bin', fw)
+    d.run(*FAST)
+    res = []
+    for opts in (('-V',), ()):
+        d.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+        d.put('loader.bin', fw)
+        r = d.run(*(opts + FAST))
+        check(r['result'] == 1 and d.flash_read(APP_ADDRESS, len(fw)) == fw,
+              '%d files, %s hint: written' % (n, 'no' if opts else 'with'))
+        res.append(r)
+    check(res[1]['dir_hits'] == res[0]['dir_hits'] + 1, '%d files: found by the hint' % n)
+    check(res[1]['sim_blocks_read'] <= res[0]['sim_blocks_read'] and
+          res[1]['time_ms'] <= res[0]['time_ms'], '%d files: hint no slower' % n)
+    print('  %3d files: %d blocks, %.2f ms without the hint; %d blocks, %.2f ms with it' %
+          (n, res[0]['sim_blocks_read'], res[0]['time_ms'],
+           res[1]['sim_blocks_read'], res[1]['time_ms']))
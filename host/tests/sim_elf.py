@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+"""ELF с карты (IMAGE_ELF): пишутся только сегменты PT_LOAD с адресов
+загрузки, отладочные секции не читаются"""
+
+from simtest import Board, app, check, elf, APP_ADDRESS
+
+RAM = 0x20000000
+
+b = Board('elf')
+
+# Как у линкера: код во flash, .data в ОЗУ с копией за кодом, .bss,
+# и отладочной информации в 8 раз больше кода
+text = app(60000, seed=71)
+data = app(3000, addr=0, seed=72)[8:]
+lma = APP_ADDRESS + len(text) + 0x100
+segs = [(APP_ADDRESS, APP_ADDRESS, text, len(text)),
+        (lma, RAM, data, len(data)),
+        (RAM + len(data), RAM + len(data), b'', 0x4000)]
+f = elf(segs, debug=8 * len(text))
+fw = text + b'\xFF' * 0x100 + data
+
+b.flash_write(APP_ADDRESS, bytes(range(256)) * 300)
+b.put('loader.elf', f)
+r = b.run('-e', '1,1,1')
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+      '.text and .data (at its LMA) written, gap erased, .bss ignored')
+check('LOADER.ELF' not in b.files(), 'file deleted after update')
+check(r['file_bytes'] < len(f) // 4 and r['sd_blocks'] * 512 < len(f) // 4,
+      'debug info not read: %d card blocks for a %d byte file' % (r['sd_blocks'], len(f)))
+
+# Заголовки программы не по порядку адресов - сортируются
+b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+b.put('loader.elf', elf(segs[::-1], debug=1000))
+r = b.run('-e', '1,1,1')
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'segments out of order')
+
+# Не тот ELF - отвергается до стирания
+for what, bad in (('overlapping segments', elf([segs[0], (APP_ADDRESS + 100, RAM, data, len(data))])),
+                  ('not ARM', elf(segs, machine=3)),
+                  ('below the loader', elf([(0x08000000, 0x08000000, text, len(text))]))):
+    b.put('loader.elf', bad)
+    r = b.run()
+    check(r['result'] != 1 and r['sim_erases'] == 0, what + ' - rejected, flash untouched')
+    b.put('loader.elf', f)
+    b.run('-e', '1,1,1')
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""Формат файла - по расширению имени, не по первым байтам"""
+
+from simtest import Board, app, check, ihex, srec, APP_ADDRESS
+from mkimage import build
+
+DATA_ADDRESS = 0x080C0000
+
+b = Board('formats')
+fw = app(40000, seed=21)
+
+for name, text in (('loader.hex', ihex), ('loader.s19', srec)):
+    b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+    b.put(name, text(fw, APP_ADDRESS))
+    r = b.run()
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, name + ' written')
+
+# Двоичные данные, которые начинаются как HEX, SREC или ELF
+for lead in (b':10000000', b'S3150800', b'\x7FELF'):
+    data = lead + app(2000, seed=22)[len(lead):]
+    b.put('calib.bin', data)
+    b.put('loader.lst', b'calib.bin 0x%08X\n' % DATA_ADDRESS)
+    r = b.run()
+    check(r['result'] == 1 and b.flash_read(DATA_ADDRESS, len(data)) == data,
+          'calib.bin starting with %r written as is' % lead[:4])
+
+# Не тот формат под именем .hex - ошибка, а не сырой образ
+b.put('loader.hex', build(fw, APP_ADDRESS))
+r = b.run()
+check(r['result'] != 1 and r['sim_erases'] == 0, 'binary named loader.hex rejected')
+check('LOADER.HEX' in b.files(), 'and left on the card')
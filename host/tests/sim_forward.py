@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Данные образа к записи во flash без копий (image_forward): целые
+секторы сплошного файла - буфером драйвера, остальное - окном FatFs;
+данные не на слове и с нечетным хвостом - через буфер, как раньше"""
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+FAST = ('-e', '1,1,1', '-p', '0')
+
+fw = app(70001, seed=121)
+b = Board('forward')
+
+
+def case(name, hdr_size, frag=0, direct=None):
+    b.flash_write(APP_ADDRESS, b'\0' * len(fw))
+    b.put('loader.bin', build(fw, APP_ADDRESS, hdr_size=hdr_size), frag=frag)
+    r = b.run(*FAST)
+    check(r['result'] == 1 and r['verify_errors'] == 0 and
+          b.flash_read(APP_ADDRESS, len(fw)) == fw and
+          b.flash_read(APP_ADDRESS + len(fw), 16) == b'\xFF' * 16,
+          '%s: written (%d bytes past the driver, %d copied)' %
+          (name, r['direct_bytes'], r['copy_bytes']))
+    if direct is not None:
+        check(direct(r['direct_bytes']), '%s: direct bytes' % name)
+    return r
+
+
+def per_mb(r):
+    return r['copy_bytes'] * 1048576.0 / r['bytes']
+
+
+# Сплошной, данные с сектора: все целые секторы - мимо FatFs
+r0 = case('sector-aligned data', 512, direct=lambda n: n >= len(fw) // 512 * 512)
+# Данные на слове, но не с сектора: первый неполный сектор - окном
+case('word-aligned data', 516, direct=lambda n: n > 0)
+# Данные не на слове - только копией, зато результат тот же
+r1 = case('unaligned data', 514)
+case('unaligned data, odd offset', 513)
+# Несплошной: все окнами через f_forward() и карту кластеров
+r2 = case('fragmented file', 512, frag=1)
+r3 = case('fragmented, unaligned', 515, frag=1)
+
+# memcpy на мегабайт образа: без копий против пути через буфер (f_read()
+# копирует из окна неполные секторы) и против f_read() кусками меньше
+# сектора, как было в main.c (копируется каждый прочитанный байт)
+check(r0['copy_bytes'] == 0 and r2['copy_bytes'] == 0, 'zero-copy paths copy nothing')
+check(r1['copy_bytes'] > 0 and r3['copy_bytes'] > 0, 'copy path counted')
+print('  memcpy per MB: zero-copy %.0f, through the buffer %.0f (%.0f eliminated),'
+      ' f_read() by 256 bytes %.0f (%.0f eliminated)' %
+      (per_mb(r0), per_mb(r1), per_mb(r1) - per_mb(r0),
+       r0['file_bytes'] * 1048576.0 / r0['bytes'],
+       (r0['file_bytes'] - r0['copy_bytes']) * 1048576.0 / r0['bytes']))
@@ -0,0 +1,32 @@
+#!/usr/bin/env python3
+"""Заголовок образа: размер и адрес проверяются для любого вида данных,
+без переполнения в арифметике"""
+
+from simtest import Board, app, check, APP_ADDRESS, FLASH_BASE, FLASH_SIZE
+import mkimage
+
+b = Board('header')
+fw = app(4096)
+
+
+def bad(name, size, addr=APP_ADDRESS, flags=0, payload=fw, hdr_size=512):
+    h = mkimage.header(size, addr, addr, mkimage.crc32_stm(payload), flags, 1, hdr_size)
+    b.put('loader.bin', h + b'\xFF' * (hdr_size - len(h)) + payload)
+    r = b.run()
+    check(r['result'] != 1 and r['sim_erases'] == 0, name + ' - rejected, flash untouched')
+
+
+bad('size past the end of file', len(fw) + 1)
+bad('size wraps past hdr_size', 0xFFFFFFFF - 100)
+bad('sparse, size past the end of flash', FLASH_BASE + FLASH_SIZE - APP_ADDRESS + 4,
+    flags=mkimage.FLAG_SPARSE, payload=mkimage.sparse(fw))
+bad('sparse, size wraps the address space', 0x100000000 - APP_ADDRESS,
+    flags=mkimage.FLAG_SPARSE, payload=mkimage.sparse(fw))
+bad('compressed, size past the end of flash', FLASH_SIZE,
+    flags=mkimage.FLAG_HS | (8 << 8) | (4 << 12))
+bad('delta, empty image', 0, flags=mkimage.FLAG_DELTA)
+bad('load address not at a sector start', len(fw), addr=APP_ADDRESS + 0x100)
+
+b.put('loader.bin', mkimage.build(fw, APP_ADDRESS, sparse_min=64))
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'good sparse image written')
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Обрыв питания посреди обновления: следующее включение продолжает
+по журналу в backup SRAM. Патч тоже - старой прошивки под ним уже нет,
+сектор, который стирался, берется из копии в запасном секторе"""
+
+import os
+import struct
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+FAST = ('-e', '1,1,1', '-p', '0')
+SPARE = 0x080E0000              # Сектор 11: копии секторов патча
+
+b = Board('resume')
+
+
+def start(data, fw):
+    """Плата со старой прошивкой, пустым журналом и файлом на карте"""
+    b.flash_write(APP_ADDRESS, b'\xFF' * 0x40000)
+    b.flash_write(APP_ADDRESS, fw)
+    if os.path.exists(b.backup):
+        os.remove(b.backup)
+    b.put('loader.bin', data)
+
+
+def cut_points(total):
+    """Первые операции, каждая граница стирания и середина сектора"""
+    return sorted(set([1, 2, 3] + [total * k // 29 for k in range(1, 29)] + [total - 1]))
+
+
+# Патч к прошивке на секторах 1-4 (16К, 16К, 16К, 64К): меняется каждый сектор
+old = app(100000, seed=41)
+new = bytearray(old)
+for i in range(0, len(new), 2048):
+    new[i + 64] ^= 0xA5
+new = bytes(new)
+patch = build(new, APP_ADDRESS, base=old)
+
+start(patch, old)
+r = b.run(*FAST)
+total = r['sim_erases'] + r['sim_programs']
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(new)) == new, 'patch applied')
+check(r['sim_erases'] == 5, 'copies packed: one spare erase for four sectors')
+
+resumed = 0
+for k in cut_points(total):
+    start(patch, old)
+    b.run('-k', k, *FAST, expect_cut=True)
+    r = b.run(*FAST)
+    if r['result'] != 1 or b.flash_read(APP_ADDRESS, len(new)) != new:
+        raise AssertionError('patch not finished after a cut at op %d of %d' % (k, total))
+    resumed += r['resumed']
+check(True, 'patch cut at %d points, each finished on the next power-up' % len(cut_points(total)))
+check(resumed > 0, 'finished sectors not rewritten (%d)' % resumed)
+
+# Два обрыва подряд: второй - уже в продолжении
+start(patch, old)
+b.run('-k', total // 3, *FAST, expect_cut=True)
+b.run('-k', total // 4, *FAST, expect_cut=True)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(new)) == new, 'two cuts in a row')
+
+# Без VBAT журнал пропал: патч к недописанной прошивке не применяется,
+# файл остается, полный образ восстанавливает
+start(patch, old)
+b.run('-k', total // 2, *FAST, expect_cut=True)
+r = b.run('-V', *FAST)
+check(r['result'] != 1 and r['sim_erases'] == 0 and 'LOADER.BIN' in b.files(),
+      'no journal - patch refused, flash untouched')
+b.put('loader.bin', build(new, APP_ADDRESS))
+r = b.run('-V', *FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(new)) == new, 'full image recovers')
+
+# Образ с заголовком: продолжение не читает с карты записанное
+full = build(app(200000, seed=42), APP_ADDRESS)
+start(full, old)
+r = b.run(*FAST)
+total = r['sim_erases'] + r['sim_programs']
+start(full, old)
+b.run('-k', total * 3 // 4, *FAST, expect_cut=True)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, 200000) == app(200000, seed=42),
+      'image finished after a cut')
+check(r['resumed'] > 0 and r['file_bytes'] < 200000, 'written part not read again')
+
+# Журнал, которому нельзя верить, - не продолжаем, а пишем заново
+img2 = app(200000, seed=43)
+full2 = build(img2, APP_ADDRESS)
+
+
+def cut_full(image):
+    start(image, old)
+    b.run('-k', total * 3 // 4, *FAST, expect_cut=True)
+
+
+def backup_patch(off, data):
+    with open(b.backup, 'r+b') as f:
+        f.seek(off)
+        f.write(data)
+
+
+# Испорчено поле done: CRC журнала не сходится
+cut_full(full2)
+backup_patch(12, b'\x00\x40')
+r = b.run(*FAST)
+check(r['result'] == 1 and r['resumed'] == 0 and b.flash_read(APP_ADDRESS, 200000) == img2,
+      'corrupted journal - full rewrite')
+
+# Журнал цел, но записанное под ним испорчено: цепочка CRC не сходится
+cut_full(full2)
+b.flash_write(APP_ADDRESS + 0x100, b'\x00' * 16)
+r = b.run(*FAST)
+check(r['result'] == 1 and r['resumed'] == 0 and b.flash_read(APP_ADDRESS, 200000) == img2,
+      'flash under the journal changed - full rewrite')
+
+# Журнал другого образа
+cut_full(full)
+b.put('loader.bin', full2)
+r = b.run(*FAST)
+check(r['result'] == 1 and r['resumed'] == 0 and b.flash_read(APP_ADDRESS, 200000) == img2,
+      'journal of another image ignored')
+
+# Патч: копия сектора в запасном испорчена - патч не продолжаем,
+# полный образ восстанавливает
+start(patch, old)
+r = b.run(*FAST)
+ptotal = r['sim_erases'] + r['sim_programs']
+start(patch, old)
+b.run('-k', ptotal * 9 // 10, *FAST, expect_cut=True)
+with open(b.backup, 'rb') as f:
+    done, copy_from, copy_len, copy_to = struct.unpack('<12xI4xIII8x', f.read(40))
+check(copy_from == APP_ADDRESS + done and copy_len > 0 and copy_to >= SPARE,
+      'copy of the interrupted sector at 0x%08X' % copy_to)
+b.flash_write(copy_to, b'\x00' * 64)
+r = b.run(*FAST)
+check(r['result'] != 1 and 'LOADER.BIN' in b.files(), 'patch with a corrupted sector copy refused')
+b.put('loader.bin', build(new, APP_ADDRESS))
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(new)) == new, 'full image recovers after the refused patch')
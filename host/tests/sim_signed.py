@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Подписанные образы (loader_signed, UPDATE_SIGNED): пишется только
+образ с подписью тестового ключа, проверка - до первого стирания"""
+
+import struct
+
+from simtest import Board, app, check, APP_ADDRESS, SIM_HZ
+from mkimage import build, crc32_stm, HDR_LEN, TEST_SIGN_KEY
+
+FAST = ('-e', '1,1,1', '-p', '0')
+
+b = Board('signed', loader='loader_signed')
+fw = app(60000, seed=81)
+good = build(fw, APP_ADDRESS, sign=TEST_SIGN_KEY)
+
+b.put('loader.bin', good)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'signed image written')
+check(r['verify_errors'] == 0, 'SHA-256 matches')
+
+# Время проверки подписи: -c 1 (такт ядра на нс PC) - оценка сверху.
+# Бюджет на загрузку - 100 мс даже на 84 МГц
+b.put('loader.bin', good)
+r = b.run('-c', 1, *FAST)
+check(r['result'] == 1 and 0 < r['sign_cycles'] and r['sign_cycles'] * 1000.0 / 84e6 < 100,
+      'signature check: %u cycles, %.1f ms at 168 MHz, %.1f ms at 84 MHz' %
+      (r['sign_cycles'], r['sign_cycles'] * 1000.0 / SIM_HZ, r['sign_cycles'] * 1000.0 / 84e6))
+
+
+def rejected(what, data):
+    b.flash_write(APP_ADDRESS, fw)
+    b.put('loader.bin', data)
+    r = b.run(*FAST)
+    check(r['result'] != 1 and r['sim_erases'] == 0 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+          what + ' - rejected, flash untouched')
+
+
+fw2 = app(60000, seed=82)
+rejected('raw image', fw2)
+rejected('no signature', build(fw2, APP_ADDRESS, sha=True))
+rejected('another key', build(fw2, APP_ADDRESS, sign=bytes(range(32))))
+
+# Заголовок изменен после подписи (CRC заголовка пересчитан)
+h = bytearray(build(fw2, APP_ADDRESS, sign=TEST_SIGN_KEY))
+struct.pack_into('<I', h, 28, 7)
+struct.pack_into('<I', h, HDR_LEN - 4, crc32_stm(h[:HDR_LEN - 4]))
+rejected('version changed after signing', bytes(h))
+
+# SHA-256 изменен вместе с данными: подпись его покрывает
+h = bytearray(build(fw2, APP_ADDRESS, sign=TEST_SIGN_KEY))
+h[HDR_LEN] ^= 1
+rejected('SHA-256 changed after signing', bytes(h))
+
+# Данные изменены: подпись цела, но данные не сходятся с заголовком
+h = bytearray(build(fw2, APP_ADDRESS, sign=TEST_SIGN_KEY))
+h[512 + 1000] ^= 1
+rejected('data changed after signing', bytes(h))
+
+# Обычный загрузчик подпись пропускает, SHA-256 проверяет
+b = Board('signed_plain')
+b.put('loader.bin', good)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw and r['verify_errors'] == 0,
+      'signed image written by the plain loader')
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Разреженный образ (IMAGE_FLAG_SPARSE): отрезки 0xFF не лежат в файле
+и не пишутся во flash, но стираются как все"""
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+FAST = ('-e', '1,1,1', '-p', '0')
+
+# Как из карты компоновщика: код, дыра до 0x08020000 (данные в секторе 5),
+# за ними еще дыра с выравниванием
+code = app(20000, seed=61)
+tail = app(3000, addr=0, seed=62)
+fw = bytearray(b'\xFF' * (0x08020000 - APP_ADDRESS + len(tail) + 0x800))
+fw[:len(code)] = code
+fw[0x08020000 - APP_ADDRESS:0x08020000 - APP_ADDRESS + len(tail)] = tail
+fw = bytes(fw)
+words = sum(1 for i in range(0, len(fw), 4) if fw[i:i + 4] != b'\xFF' * 4)
+
+b = Board('sparse')
+junk = bytes(range(256)) * (len(fw) // 256 + 1)
+
+# Обычный образ: 0xFF лежат в файле, пропускаются уже при записи
+b.flash_write(APP_ADDRESS, junk[:len(fw)])
+b.put('loader.bin', build(fw, APP_ADDRESS))
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'plain image written')
+plain = r
+
+b.flash_write(APP_ADDRESS, junk[:len(fw)])
+img = build(fw, APP_ADDRESS, sparse_min=64)
+b.put('loader.bin', img)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+      'sparse image written, gaps erased (%d bytes from a %d byte file)' % (len(fw), len(img)))
+check(r['verify_errors'] == 0, 'verified')
+check(r['sim_programs'] == words and r['sim_overprogram'] == 0,
+      'only non-erased words programmed (%d of %d)' % (words, len(fw) // 4))
+check(r['flash_skipped'] >= (len(fw) - len(code) - len(tail)) // 4,
+      '%d erased words not programmed' % r['flash_skipped'])
+check(len(img) < len(code) + len(tail) + 1024 and r['file_bytes'] < plain['file_bytes'] // 3,
+      'gaps not read from the card (%d vs %d bytes)' % (r['file_bytes'], plain['file_bytes']))
+
+# Отрезки короче min_run - в данных; запись та же
+fw2 = bytearray(app(8192, seed=63))
+for i in range(100, 8000, 300):
+    fw2[i:i + 40] = b'\xFF' * 40
+fw2 = bytes(fw2)
+b.put('loader.bin', build(fw2, APP_ADDRESS, sparse_min=64))
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw2)) == fw2, 'short runs kept as data')
+
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Чтение карты потоком CMD18: поток не рвется на каждом f_read(),
+блок принимается по DMA с любым сдвигом токена"""
+
+from simtest import Board, app, check, APP_ADDRESS, SIM_HZ
+from mkimage import build
+
+FAST = ['-e', '1,1,1', '-p', '0']       # Flash не мешает мерить карту
+
+b = Board('stream')
+fw = app(400000, seed=4)
+blocks = (len(fw) + 511) // 512
+
+b.put('loader.bin', fw)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'contiguous file written')
+check(r['sd_streams'] < 20, 'one stream per pass, not per block (%d)' % r['sd_streams'])
+check(r['sim_blocks_read'] < 2 * blocks + 20, 'blocks read ahead and unused are few')
+print('  400K: %.1f ms, %d blocks in %d streams, %d hits' %
+      (r['time_ms'], r['sim_blocks_read'], r['sd_streams'], r['sd_hits']))
+
+b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+b.put('loader.bin', fw, frag=1)
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'fragmented file written')
+check(r['sd_streams'] > blocks // 4, 'new stream on every cluster jump')
+
+# Токен позже, чем DMA кончился, и токен в середине приема
+for gap in (2000, 3, 60):
+    b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+    b.put('loader.bin', fw)
+    r = b.run('-g', gap, *FAST)
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw,
+          'gap %d us between blocks: file written' % gap)
+    if gap > 1000:
+        check(r['sd_late'] > 0, 'late tokens waited for')
+
+# Доля приема DMA, пока процессор пишет flash, и скорость обновления при
+# разных задержках карты (-a, -g) и записи слова (-p)
+for a, g, p in ((100, 5, 4), (500, 20, 16), (2000, 200, 60)):
+    b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+    b.put('loader.bin', fw)
+    r = b.run('-a', a, '-g', g, '-p', p, '-e', '1,1,1')
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw and
+          r['sd_overlap_ratio'] > 0,
+          '-a %d -g %d -p %d: card read overlapped with flash (%.0f%%, %.1f KB/s)' %
+          (a, g, p, r['sd_overlap_ratio'] * 100, r['throughput_kbs']))
+
+# Ошибка чтения посреди потока: поток закрыт, flash не стерта зря
+b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+b.put('loader.bin', fw)
+r = b.run('-x', b.fs.cluster_lba(2) + 300, *FAST)
+check(r['result'] != 1, 'read error reported')
+r = b.run(*FAST)
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw, 'next power-up writes it')
+
+# Сплошной файл (буфер на несколько секторов, disk_read_forward) против
+# f_forward() по сектору: тот же образ, кластеры по 32К, у второго файла
+# - через один. Запись во flash идет одновременно с чтением карты и там,
+# и там. Код на модели бесплатный (без -c), так что числа воспроизводятся:
+# время - карта и flash, включая 250 мс на светодиод в конце обновления
+
+img = build(fw, APP_ADDRESS, sha=True)
+res = {}
+for name, frag in (('direct', 0), ('f_forward', 1)):
+    d = Board('stream_' + name, size_mb=512, cluster=64)
+    d.put('loader.bin', img, frag=frag)
+    r = d.run(*FAST)
+    check(r['result'] == 1 and d.flash_read(APP_ADDRESS, len(fw)) == fw, name + ': written')
+    res[name] = r
+    print('  %-9s %.1f ms, %.3f MB/s, %d driver calls, %d card commands, %d streams' %
+          (name, r['time_ms'], len(img) / 1e3 / r['time_ms'], r['sd_reads'], r['sim_cmds'],
+           r['sd_streams']))
+rd, rf = res['direct'], res['f_forward']
+check(rd['direct_bytes'] >= len(fw) and rf['direct_bytes'] == 0, 'contiguous file read past FatFs')
+check(rd['sd_reads'] * 5 < rf['sd_reads'], 'several sectors per driver call')
+check(rd['sim_cmds'] < rf['sim_cmds'], 'fewer card commands')
+check(rd['time_ms'] <= rf['time_ms'], 'no slower than f_forward with the card alone')
+
+# SHA-256 по ходу записи: такты на байт образа. Расчет на PC - по часам
+# PC (-c 1: такт ядра на нс), так что это оценка сверху
+d = Board('stream_direct', size_mb=512, cluster=64)
+d.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+d.put('loader.bin', img)
+r = d.run('-c', 1, *FAST)
+check(r['result'] == 1 and d.flash_read(APP_ADDRESS, len(fw)) == fw and
+      0 < r['sha_cycles'] < 100 * len(fw),
+      'SHA-256 on the way: %.1f cycles/byte, %.1f ms per 400K at 168 MHz' %
+      (r['sha_cycles'] / len(fw), r['sha_cycles'] * 1000.0 / SIM_HZ))
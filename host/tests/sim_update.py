@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Обновление с карты целиком на модели: сырой образ и образ с заголовком"""
+
+from simtest import Board, app, check, APP_ADDRESS, SIM_HZ
+from mkimage import build
+
+b = Board('update')
+fw = app(100000)
+mark = app(1000, seed=9)
+b.flash_write(0x08020000, mark)             # Сектор 5: образ до него не достает
+b.put('loader.bin', fw)
+r = b.run()
+check(r['result'] == 1, 'raw image written')
+check(b.flash_read(APP_ADDRESS, len(fw)) == fw, 'flash matches raw image')
+check('LOADER.BIN' not in b.files(), 'file deleted after update')
+check(r['sim_flash_errors'] == 0 and r['sim_overprogram'] == 0, 'no flash misuse')
+check(r['sim_programs'] <= len(fw) // 4, 'programmed by words (%d writes)' % r['sim_programs'])
+check(r['sim_erases'] == 4 and r['erased'] == 4, 'only sectors 1-4 erased')
+check(b.flash_read(0x08020000, len(mark)) == mark, 'sector 5 untouched')
+print('  raw 100K: %.1f ms, %d sectors erased' % (r['time_ms'], r['sim_erases']))
+
+r = b.run()
+check(r['result'] == 0 and r['sim_erases'] == 0, 'no file - flash untouched')
+
+fw2 = app(300000, seed=2)
+b.put('loader.bin', build(fw2, APP_ADDRESS, version=7, sha=True))
+r = b.run()
+check(r['result'] == 1 and r['version'] == 7, 'image with header written')
+check(b.flash_read(APP_ADDRESS, len(fw2)) == fw2, 'flash matches image')
+check(r['verify_errors'] == 0, 'verified')
+print('  header 300K: %.1f ms, card %d blocks in %d streams' %
+      (r['time_ms'], r['sim_blocks_read'], r['sd_streams']))
+
+b.put('loader.bin', build(fw2, APP_ADDRESS, version=7, sha=True))
+r = b.run()
+check(r['result'] == 1 and r['sim_erases'] == 0 and r['sim_programs'] == 0,
+      'same image again - nothing erased')
+
+# Поменялся один байт в секторе 5 (128К): стирается только он
+fw3 = bytearray(fw2)
+fw3[0x08020000 - APP_ADDRESS + 1234] ^= 0xFF
+fw3 = bytes(fw3)
+b.put('loader.bin', build(fw3, APP_ADDRESS, version=8, sha=True))
+r = b.run()
+check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw3)) == fw3, 'one byte changed - written')
+check(r['sim_erases'] == 1 and r['erased'] == 1 and r['skipped'] == 5,
+      'only the changed sector erased, 5 skipped')
+
+# Без задержки на каждый кусок: с быстрой flash 100K - это время карты.
+# SysTick (он же мигает индикатором хода) идет все обновление
+b.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+b.put('loader.bin', fw)
+r = b.run('-e', '1,1,1', '-p', '0')
+check(r['result'] == 1 and r['time_ms'] < 1000, 'no per-chunk stall (%.1f ms)' % r['time_ms'])
+check(abs(r['update_ms'] - r['time_ms']) < 20, 'SysTick runs during the update')
+
+# С индикатором хода и без него (loader_noled): то же время по модели,
+# индикатор мигает только у первого. С временем кода на PC (-c 1) -
+# медиана трех включений, для сведения
+res = {}
+for loader in ('loader', 'loader_noled'):
+    d = Board('update_' + loader, loader=loader)
+    times = []
+    for opts in ((), ('-c', 1), ('-c', 1), ('-c', 1)):
+        d.flash_write(APP_ADDRESS, b'\xFF' * len(fw))
+        d.put('loader.bin', fw)
+        r = d.run(*opts)
+        check(r['result'] == 1 and d.flash_read(APP_ADDRESS, len(fw)) == fw,
+              '%s: written' % loader)
+        if opts:
+            times.append(r['time_ms'])
+        else:
+            res[loader] = r
+    print('  %-12s %.1f ms, with CPU time %.1f ms, %d LED toggles' %
+          (loader, res[loader]['time_ms'], sorted(times)[1], res[loader]['sim_led_toggles']))
+check(res['loader']['sim_led_toggles'] > res['loader_noled']['sim_led_toggles'] + 5,
+      'progress indicator blinks only when enabled')
+check(abs(res['loader']['time_ms'] - res['loader_noled']['time_ms']) < 1,
+      'progress indicator costs no update time')
+
+# Проверка CRC после записи: образ до запасного сектора 11 (880К), такты
+# sector_verify() - в мс на 1М при SystemCoreClock. На PC вместо блока
+# CRC - программный CRC, его время - по часам PC (-c 1), так что это
+# верхняя граница
+big = app(0x080E0000 - APP_ADDRESS, seed=81)
+d = Board('update_verify')
+d.put('loader.bin', big)
+r = d.run('-c', 1, '-e', '1,1,1', '-p', '0')
+ms = r['verify_cycles'] * 1000.0 / SIM_HZ * 0x100000 / len(big)
+check(r['result'] == 1 and r['verify_errors'] == 0 and
+      d.flash_read(APP_ADDRESS, len(big)) == big, '%dK written and verified' % (len(big) // 1024))
+check(0 < ms < 100, 'verification of 1M in tens of ms at %d MHz, not seconds (%.1f ms)' %
+      (SIM_HZ // 1000000, ms))
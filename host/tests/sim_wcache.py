@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+"""Кэш секторов за окном FatFs (_FS_WINS): монтирование, поиск в
+каталоге, чтение файла по FAT и удаление - меньше чтений карты, чем
+с одним окном (loader_win1), а карта после обновления та же"""
+
+from simtest import Board, app, check, APP_ADDRESS
+from mkimage import build
+
+FAST = ('-e', '1,1,1', '-p', '0')
+
+fw = app(150000, seed=111)
+data = app(3000, addr=0, seed=112)
+
+
+def board(name, loader):
+    """Каталог на 200 файлов, файл образа по секторному кластеру через
+    кластер (не влезает в карту кластеров - читается по FAT), манифест
+    с файлом данных"""
+    b = Board(name, loader=loader, size_mb=16, cluster=1)
+    for i in range(200):
+        b.put('f%02d.txt' % i, b'x' * (100 + i))
+    b.put('app.bin', build(fw, APP_ADDRESS), frag=1)
+    b.put('calib.bin', data)
+    b.put('loader.lst', b'app.bin\ncalib.bin 0x080C0000\n')
+    r = b.run(*FAST)
+    check(r['result'] == 1 and b.flash_read(APP_ADDRESS, len(fw)) == fw and
+          b.flash_read(0x080C0000, len(data)) == data, loader + ': written')
+    print('  %-12s %4d blocks read, %d written, window hits %d, misses %d' %
+          (loader, r['sim_blocks_read'], r['sim_blocks_written'], r['win_hits'],
+           r['win_misses']))
+    with open(b.disk, 'rb') as f:
+        return r, f.read(), b.files()
+
+
+one, disk1, files1 = board('wcache1', 'loader_win1')
+many, disk, files = board('wcache', 'loader')
+check(many['unmapped'] == 1, 'image read through the FAT')
+check(many['win_hits'] > 0, 'cache hits')
+check(many['sim_blocks_read'] * 4 < one['sim_blocks_read'] * 3,
+      'fewer card reads than with one window (%d vs %d)' %
+      (many['sim_blocks_read'], one['sim_blocks_read']))
+check('APP.BIN' not in files and 'LOADER.LST' not in files, 'files deleted after update')
+check(disk == disk1, 'card after the update the same as with one window')
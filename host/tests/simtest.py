@@ -0,0 +1,152 @@
+"""Общее для сценариев sim_*.py: карта, flash, запуск loader.
+
+Каждый сценарий работает в своем каталоге work/<имя>: там sd.img,
+flash.bin и backup.bin - то, что переживает выключение платы.
+"""
+
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+HOST = os.path.dirname(HERE)
+sys.path.insert(0, os.path.join(HOST, 'tools'))
+
+import fat16            # noqa: E402
+import mkimage          # noqa: E402
+
+FLASH_BASE = 0x08000000
+FLASH_SIZE = 0x100000
+APP_ADDRESS = 0x08004000
+EXIT_CUT = 3
+SIM_HZ = 168000000             # SystemCoreClock модели
+
+
+def app(size, addr=APP_ADDRESS, seed=1):
+    """Приложение: таблица векторов (SP в ОЗУ, Reset внутри) и шум"""
+    r = random.Random(seed)
+    body = bytearray(r.getrandbits(8) for _ in range(size))
+    struct.pack_into('<II', body, 0, 0x20020000, addr + 0x101)
+    return bytes(body)
+
+
+def ihex(data, addr):
+    """Intel HEX: записи по 16 байт, адрес - записями типа 04"""
+    out, hi = [], None
+
+    def rec(t, a, b):
+        r = bytes([len(b), a >> 8, a & 0xFF, t]) + b
+        out.append(':%s%02X' % (r.hex().upper(), -sum(r) & 0xFF))
+    for i in range(0, len(data), 16):
+        a = addr + i
+        if a >> 16 != hi:
+            hi = a >> 16
+            rec(4, 0, struct.pack('>H', hi))
+        rec(0, a & 0xFFFF, bytes(data[i:i + 16]))
+    rec(1, 0, b'')
+    return ('\r\n'.join(out) + '\r\n').encode()
+
+
+def srec(data, addr):
+    """Motorola S-record: S3 с 32-битным адресом по 16 байт"""
+    out = []
+    for i in range(0, len(data), 16):
+        b = bytes(data[i:i + 16])
+        r = bytes([len(b) + 5]) + struct.pack('>I', addr + i) + b
+        out.append('S3%s%02X' % (r.hex().upper(), ~sum(r) & 0xFF))
+    out.append('S70500000000FA')
+    return ('\r\n'.join(out) + '\r\n').encode()
+
+
+def elf(segments, debug=0, machine=40, seed=1):
+    """ELF32 как у arm-none-eabi-ld: сегменты (p_paddr, p_vaddr, данные,
+    p_memsz) с файловых смещений, кратных 0x10000, за ними debug байт
+    отладочных секций и таблица секций (ее загрузчик не читает)"""
+    r = random.Random(seed)
+    phoff, off, body = 52, 0x10000, bytearray()
+    ph = b''
+    for paddr, vaddr, data, memsz in segments:
+        body += b'\0' * (off - 0x10000 - len(body)) + data
+        ph += struct.pack('<8I', 1, off if data else 0, vaddr, paddr, len(data), memsz,
+                          5, 0x10000)
+        off = (0x10000 + len(body) + 0xFFFF) & ~0xFFFF
+    body += bytes(r.getrandbits(8) for _ in range(debug))
+    shoff = 0x10000 + len(body)
+    eh = struct.pack('<4s5B7x2H5I6H', b'\x7FELF', 1, 1, 1, 0, 0, 2, machine, 1,
+                     segments[0][0] | 1, phoff, shoff, 0x05000200, 52, 32,
+                     len(segments), 40, 0, 0)
+    head = eh + ph
+    return head + b'\0' * (0x10000 - len(head)) + bytes(body)
+
+
+class Board:
+    def __init__(self, name, loader='loader', size_mb=64, cluster=4):
+        self.dir = os.path.join(HOST, 'work', name)
+        shutil.rmtree(self.dir, ignore_errors=True)
+        os.makedirs(self.dir)
+        self.loader = os.path.join(HOST, loader)
+        self.disk = os.path.join(self.dir, 'sd.img')
+        self.flash = os.path.join(self.dir, 'flash.bin')
+        self.backup = os.path.join(self.dir, 'backup.bin')
+        self.fs = fat16.Fat16(self.disk, size_mb, cluster, create=True)
+        self.fs.save()
+
+    # Карта: положить файлы (пока плата выключена)
+    def put(self, name, data, **kw):
+        self.fs = fat16.Fat16(self.disk)
+        self.fs.add(name, data, **kw)
+        self.fs.save()
+
+    def remove(self, name):
+        self.fs = fat16.Fat16(self.disk)
+        self.fs.remove(name)
+        self.fs.save()
+
+    def files(self):
+        return fat16.Fat16(self.disk).names()
+
+    # Flash
+    def flash_write(self, addr, data):
+        img = bytearray(self.flash_read())
+        img[addr - FLASH_BASE:addr - FLASH_BASE + len(data)] = data
+        with open(self.flash, 'wb') as f:
+            f.write(img)
+
+    def flash_read(self, addr=FLASH_BASE, size=FLASH_SIZE):
+        if not os.path.exists(self.flash):
+            return b'\xFF' * size
+        with open(self.flash, 'rb') as f:
+            f.seek(addr - FLASH_BASE)
+            return f.read(size).ljust(size, b'\xFF')
+
+    def run(self, *opts, expect_cut=False, card=True):
+        """Одно включение платы (card=False - без карты).
+        Результат - словарь ключ=значение"""
+        disk = self.disk if card else self.disk + '.none'
+        p = subprocess.run([self.loader, '-d', disk, '-f', self.flash,
+                            '-b', self.backup] + [str(o) for o in opts],
+                           stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                           universal_newlines=True)
+        if p.returncode == EXIT_CUT:
+            if not expect_cut:
+                raise AssertionError('unexpected power cut: ' + p.stderr)
+            return None
+        if p.returncode != 0:
+            raise AssertionError('loader failed (%d): %s' % (p.returncode, p.stderr))
+        out = {}
+        for line in p.stdout.splitlines():
+            k, _, v = line.partition('=')
+            try:
+                out[k] = int(v, 0)
+            except ValueError:
+                out[k] = float(v)
+        return out
+
+
+def check(cond, what):
+    if not cond:
+        raise AssertionError(what)
+    print('  ok  ' + what)
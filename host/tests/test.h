@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Unit   PC:      
+ * (#include "../../x.c")    CHECK().   
+ * (flash, F_SIZE, backup SRAM) - test_board(),   work/ (make test)
+ *****************************************************************************/
+#ifndef _TEST_H
+#define _TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simcore.h"
+
+
+static int test_failed;
+
+#define CHECK(cond)	do { \
+	if (!(cond)) { \
+	    printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+	    test_failed++; \
+	} \
+    } while (0)
+
+#define CHECK_EQ(a, b)	do { \
+	long long _a = (long long) (a), _b = (long long) (b); \
+	if (_a != _b) { \
+	    printf("  FAIL %s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #a, _a, _b); \
+	    test_failed++; \
+	} \
+    } while (0)
+
+
+/*  :  flash,  backup SRAM,   */
+static inline void test_board(const char *name)
+{
+    static char flash[64], backup[64], disk[64];
+
+    snprintf(flash, sizeof(flash), "work/%s.flash", name);
+    snprintf(backup, sizeof(backup), "work/%s.backup", name);
+    snprintf(disk, sizeof(disk), "work/%s.none", name);
+    remove(flash);
+    remove(backup);
+    sim.flash = flash;
+    sim.backup = backup;
+    sim.disk = disk;
+    sim_init();
+}
+
+
+static int test_done(const char *name)
+{
+    printf("  %s: %s\n", name, test_failed ? "FAILED" : "ok");
+    return test_failed ? 1 : 0;
+}
+
+#endif /* test.h */
@@ -0,0 +1,136 @@
+/******************************************************************************
+ * utils/aes.c:  FIPS-197 ( C), CTR  SP 800-38A (F.5.1,
+ * F.5.5)    ,    64 .
+ *  -    PC (  )
+ *****************************************************************************/
+#include <time.h>
+#include "test.h"
+#include "../../utils/aes.c"
+
+
+static int unhex(u8 * out, const char *s)
+{
+    int n = 0;
+    unsigned v;
+
+    for (; s[0] && s[1]; s += 2) {
+	sscanf(s, "%2x", &v);
+	out[n++] = (u8) v;
+    }
+    return n;
+}
+
+
+static void test_blocks(void)
+{
+    static const char *ct[] = {
+	"69c4e0d86a7b0430d8cdb78070b4c55a",
+	"dda97ca4864cdfe06eaf70a0ec0d7191",
+	"8ea2b7ca516745bfeafc49904b496089",
+    };
+    u8 key[32], iv[16] = { 0 }, buf[16], expect[16];
+    aes_t a;
+    int i;
+
+    for (i = 0; i < 32; i++)
+	key[i] = (u8) i;
+    for (i = 0; i < 3; i++) {
+	CHECK(aes_init(&a, key, 16 + 8 * i, iv));
+	unhex(buf, "00112233445566778899aabbccddeeff");
+	unhex(expect, ct[i]);
+	aes_encrypt(&a, buf, buf);
+	CHECK(memcmp(buf, expect, 16) == 0);
+    }
+    CHECK(!aes_init(&a, key, 20, iv));
+}
+
+
+static const char pt[] =
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+
+
+/*  plain (NULL - )   ,  
+ *   , -   cipher */
+static void check_ctr(const char *key, const char *iv, const char *plain, const char *cipher)
+{
+    static const int steps[] = { 64, 1, 5, 16, 17, 33 };
+    u8 k[32], v[16], buf[64 + 3], expect[64];
+    aes_t a;
+    int klen, n, i, j, shift, m;
+
+    klen = unhex(k, key);
+    unhex(v, iv);
+    n = unhex(expect, cipher);
+    for (shift = 0; shift < 4; shift += 3) {
+	for (i = 0; i < (int) (sizeof(steps) / sizeof(steps[0])); i++) {
+	    CHECK(aes_init(&a, k, klen, v));
+	    memset(buf, 0, sizeof(buf));
+	    if (plain)
+		unhex(buf + shift, plain);
+	    for (j = 0; j < n; j += m) {
+		m = (n - j < steps[i]) ? n - j : steps[i];
+		aes_ctr(&a, j, buf + shift + j, m);
+	    }
+	    CHECK(memcmp(buf + shift, expect, n) == 0);
+	}
+    }
+}
+
+
+static void test_ctr(void)
+{
+    u8 k[16], v[16], buf[64], ref[64];
+    aes_t a;
+
+    /* SP 800-38A F.5.1, F.5.5 */
+    check_ctr("2b7e151628aed2a6abf7158809cf4f3c", "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", pt,
+	      "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+	      "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+    check_ctr("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+	      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", pt,
+	      "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+	      "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6");
+
+    /*     64  (openssl enc -aes-128-ctr) */
+    check_ctr("000102030405060708090a0b0c0d0e0f", "00000000000000fffffffffffffffffe", NULL,
+	      "2c9a10e3ac9b3dbdac7db576d610a7d565967630aeffeb0752d256a492f30099"
+	      "998d35f017fc11943fd2740d536b4694");
+
+    /*   :    ,     */
+    unhex(k, "2b7e151628aed2a6abf7158809cf4f3c");
+    unhex(v, "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    unhex(ref, "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+	  "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+    unhex(buf, pt);
+    CHECK(aes_init(&a, k, 16, v));
+    aes_ctr(&a, 40, buf + 40, 24);
+    aes_ctr(&a, 0, buf, 40);
+    CHECK(memcmp(buf, ref, 64) == 0);
+}
+
+
+static void bench(void)
+{
+    static u8 buf[1 << 20];
+    u8 key[16] = { 0 }, iv[16] = { 0 };
+    aes_t a;
+    clock_t t;
+    int i;
+
+    aes_init(&a, key, sizeof(key), iv);
+    t = clock();
+    for (i = 0; i < 8; i++)
+	aes_ctr(&a, i * sizeof(buf), buf, sizeof(buf));
+    t = clock() - t;
+    printf("  aes-128-ctr on this PC: %.1f MB/s\n", 8.0 * CLOCKS_PER_SEC / (t ? t : 1));
+}
+
+
+int main(void)
+{
+    test_blocks();
+    test_ctr();
+    bench();
+    return test_done("aes");
+}
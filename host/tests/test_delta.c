@@ -0,0 +1,180 @@
+/******************************************************************************
+ * delta.c:  ,    flash    ,
+ *      , delta_skip()
+ *****************************************************************************/
+#include "test.h"
+#include "../../delta.c"
+#include "../../periph/flash.c"
+#include "../../Library/STM32F4xx_StdPeriph_Driver/src/stm32f4xx_flash.c"
+
+#define BASE		0x08004000	/*  1  2 -   */
+#define BASE_SIZE	0x8000
+#define COPY		0x0800C000	/*  3 - ""    */
+
+
+static u8 patch[0x9000];
+static int patch_len, patch_pos;
+
+
+static int patch_in(void *buf, int len)
+{
+    if (len > patch_len - patch_pos)
+	len = patch_len - patch_pos;
+    memcpy(buf, patch + patch_pos, len);
+    patch_pos += len;
+    return len;
+}
+
+
+/*  :     - (  + add) */
+static void cmd(u32 diff, u32 extra, s32 seek, u8 add)
+{
+    delta_cmd_t c = { diff, extra, seek };
+    u32 i;
+
+    memcpy(patch + patch_len, &c, sizeof(c));
+    patch_len += sizeof(c);
+    for (i = 0; i < diff + extra; i++)
+	patch[patch_len++] = (u8) (i + add);
+}
+
+
+static u8 old_byte(u32 addr)
+{
+    return (u8) ((addr - BASE) * 13 + 5);
+}
+
+
+static void start(delta_t * d)
+{
+    delta_header_t dh = { DELTA_MAGIC, BASE_SIZE, 0 };
+
+    patch_pos = 0;
+    CHECK(delta_start(d, patch_in, BASE, &dh));
+}
+
+
+static void put_old(void)
+{
+    static u8 buf[BASE_SIZE];
+    u32 i;
+
+    for (i = 0; i < BASE_SIZE; i++)
+	buf[i] = old_byte(BASE + i);
+    FLASH_Unlock();
+    flash_erase_sector(1);
+    flash_erase_sector(2);
+    flash_erase_sector(3);
+    flash_write(BASE, buf, BASE_SIZE);
+    memset(buf, 0x40, 0x4000);
+    flash_write(COPY, buf, 0x4000);
+    FLASH_Lock();
+}
+
+
+/* ,  ,   ;     */
+static void test_commands(void)
+{
+    static const int steps[] = { 100, 1, 3, 7 };
+    delta_t d;
+    u8 out[32];
+    int i, n, k;
+
+    patch_len = 0;
+    cmd(8, 4, 8, 0x10);		/* old[0..8) + , 4 , old += 8 */
+    cmd(4, 0, 0, 0x20);		/* old[16..20) +  */
+
+    for (k = 0; k < (int) (sizeof(steps) / sizeof(steps[0])); k++) {
+	start(&d);
+	memset(out, 0, sizeof(out));
+	for (n = 0; n < 16; n += i)
+	    if ((i = delta_read(&d, out + n, steps[k])) <= 0)
+		break;
+	CHECK_EQ(n, 16);
+	CHECK_EQ(delta_read(&d, out + n, 1), 0);
+	for (i = 0; i < 8; i++)
+	    CHECK_EQ(out[i], (u8) (old_byte(BASE + i) + i + 0x10));
+	for (i = 8; i < 12; i++)
+	    CHECK_EQ(out[i], (u8) (i + 0x10));
+	for (i = 0; i < 4; i++)
+	    CHECK_EQ(out[12 + i], (u8) (old_byte(BASE + 16 + i) + i + 0x20));
+    }
+
+    /*     */
+    patch_len -= 2;
+    start(&d);
+    CHECK_EQ(delta_read(&d, out, 16), -1);
+}
+
+
+/*     2:    1   */
+static void test_refuse(void)
+{
+    delta_t d;
+    static u8 out[0x4000];
+
+    patch_len = 0;
+    cmd(0, 0x4000, 0, 0);
+    cmd(4, 0, 0, 0);
+    start(&d);
+    CHECK_EQ(delta_read(&d, out, 0x4000), 0x4000);
+    CHECK_EQ(delta_read(&d, out, 4), -1);
+
+    /*   ,      */
+    patch_len = 0;
+    cmd(0, 0, BASE_SIZE, 0);
+    cmd(1, 0, 0, 0);
+    start(&d);
+    CHECK_EQ(delta_read(&d, out, 1), -1);
+}
+
+
+/*  :       */
+static void test_copy(void)
+{
+    delta_t d;
+    u8 out[8];
+    int i;
+
+    patch_len = 0;
+    cmd(8, 0, 0, 1);
+    start(&d);
+    delta_copy(&d, BASE, 0x4000, COPY);
+    CHECK_EQ(delta_read(&d, out, 8), 8);
+    for (i = 0; i < 8; i++)
+	CHECK_EQ(out[i], (u8) (0x40 + i + 1));
+}
+
+
+/*    ,  ,      */
+static void test_skip(void)
+{
+    delta_t d;
+    u8 out[4];
+    int i;
+
+    patch_len = 0;
+    cmd(0, 0x4000, 0, 0);
+    cmd(4, 0, 0x4000 + 4, 0);
+    cmd(4, 0, 0, 0x30);
+    start(&d);
+    CHECK(delta_skip(&d, 0x4000 + 4));
+    CHECK_EQ(delta_read(&d, out, 4), 4);
+    for (i = 0; i < 4; i++)
+	CHECK_EQ(out[i], (u8) (old_byte(BASE + 0x4008 + i) + i + 0x30));
+
+    start(&d);
+    CHECK(!delta_skip(&d, 0x4000 + 9));
+}
+
+
+int main(void)
+{
+    test_board("test_delta");
+    put_old();
+    test_commands();
+    test_refuse();
+    test_copy();
+    test_skip();
+    return test_done("delta");
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * utils/ed25519.c:  RFC 8032 (7.1, TEST 1-3)  :
+ *  , , , S   L,    .
+ *   :   PC (TSC  x86,   x -c, 
+ * loader -c)      SystemCoreClock 168  84 
+ *****************************************************************************/
+#include <time.h>
+#include <unistd.h>
+#include "test.h"
+#include "../../utils/ed25519.c"
+
+
+static const struct {
+    const char *key, *msg, *sig;
+} vec[] = {
+    {"d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a", "",
+     "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+     "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"},
+    {"3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c", "72",
+     "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+     "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"},
+    {"fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025", "af82",
+     "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac"
+     "18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a"},
+};
+
+
+static int unhex(u8 * out, const char *s)
+{
+    int n = 0;
+    unsigned v;
+
+    for (; s[0] && s[1]; s += 2) {
+	sscanf(s, "%2x", &v);
+	out[n++] = (u8) v;
+    }
+    return n;
+}
+
+
+static void test_vectors(void)
+{
+    u8 key[32], msg[8], sig[64];
+    int i, n;
+
+    for (i = 0; i < (int) (sizeof(vec) / sizeof(vec[0])); i++) {
+	unhex(key, vec[i].key);
+	n = unhex(msg, vec[i].msg);
+	unhex(sig, vec[i].sig);
+	CHECK(ed25519_verify(sig, msg, n, key));
+    }
+}
+
+
+/*    -  */
+static void test_tamper(void)
+{
+    u8 key[32], msg[8], sig[64], bad[64];
+    int n, bit;
+
+    unhex(key, vec[2].key);
+    n = unhex(msg, vec[2].msg);
+    unhex(sig, vec[2].sig);
+
+    msg[1] ^= 0x01;
+    CHECK(!ed25519_verify(sig, msg, n, key));
+    msg[1] ^= 0x01;
+    CHECK(!ed25519_verify(sig, msg, n - 1, key));
+
+    for (bit = 0; bit < 512; bit += 37) {
+	memcpy(bad, sig, sizeof(bad));
+	bad[bit / 8] ^= 1 << (bit % 8);
+	CHECK(!ed25519_verify(bad, msg, n, key));
+    }
+
+    /*    */
+    unhex(key, vec[1].key);
+    CHECK(!ed25519_verify(sig, msg, n, key));
+}
+
+
+static void test_malformed(void)
+{
+    u8 key[32], sig[64];
+
+    /* TEST 1  S + L:   ,     */
+    unhex(key, vec[0].key);
+    unhex(sig, vec[0].sig);
+    unhex(sig + 32, "4c8c7872aa064e049dbb3013fbf29380d25bf5f0595bbe24655141438e7a101b");
+    CHECK(!ed25519_verify(sig, (const u8 *) "", 0, key));
+
+    /* y = 2 -      */
+    unhex(sig, vec[0].sig);
+    memset(key, 0, sizeof(key));
+    key[0] = 2;
+    CHECK(!ed25519_verify(sig, (const u8 *) "", 0, key));
+}
+
+
+static void bench(double cpu)
+{
+    u8 key[32], msg[8], sig[64];
+    struct timespec t0, t1;
+    unsigned long long c = 0;
+    double ns, cycles;
+    int i, n, ok = 1;
+
+    unhex(key, vec[2].key);
+    n = unhex(msg, vec[2].msg);
+    unhex(sig, vec[2].sig);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+#if defined(__x86_64__) || defined(__i386__)
+    c = __builtin_ia32_rdtsc();
+#endif
+    for (i = 0; i < 20; i++)
+	ok &= ed25519_verify(sig, msg, n, key);
+#if defined(__x86_64__) || defined(__i386__)
+    c = __builtin_ia32_rdtsc() - c;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    CHECK(ok);
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 20;
+    if (c && cpu == 0) {
+	cycles = c / 20.0;
+	printf("  ed25519_verify on this PC: %.3f ms, %.0f TSC cycles", ns / 1e6, cycles);
+    } else {
+	cycles = ns * (cpu ? cpu : 1);
+	printf("  ed25519_verify on this PC: %.3f ms, x %g = %.0f cycles", ns / 1e6,
+	       cpu ? cpu : 1, cycles);
+    }
+    printf(": %.1f ms at 168 MHz, %.1f ms at 84 MHz\n", cycles / 168e3, cycles / 84e3);
+}
+
+
+int main(int argc, char **argv)
+{
+    double cpu = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "c:")) != -1) {
+	if (c == 'c')
+	    cpu = atof(optarg);
+    }
+    test_vectors();
+    test_tamper();
+    test_malformed();
+    bench(cpu);
+    return test_done("ed25519");
+}
@@ -0,0 +1,205 @@
+/******************************************************************************
+ * periph/flash.c:       flash, 
+ *    (test_flash -c x:     PC,  loader -c)
+ *****************************************************************************/
+#include <unistd.h>
+#include "test.h"
+#include "../../periph/flash.c"
+#include "../../Library/STM32F4xx_StdPeriph_Driver/src/stm32f4xx_flash.c"
+
+
+static void test_range(void)
+{
+    int first = -2, last = -2;
+
+    CHECK_EQ(flash_sector_count(), 12);
+
+    CHECK_EQ(flash_sector_range(0x08004000, 1, &first, &last), 1);
+    CHECK_EQ(first, 1);
+    CHECK_EQ(last, 1);
+    CHECK_EQ(flash_sector_range(0x08004000, 0x4000, &first, &last), 1);
+    CHECK_EQ(flash_sector_range(0x08004000, 0x4001, &first, &last), 2);
+    CHECK_EQ(last, 2);
+    CHECK_EQ(flash_sector_range(0x08004000, 0x1C000, &first, &last), 4);
+    CHECK_EQ(last, 4);
+
+    /*   flash - ,  -  */
+    CHECK_EQ(flash_sector_range(0x080E0000, 0x20000, &first, &last), 1);
+    CHECK_EQ(last, 11);
+    CHECK_EQ(flash_sector_range(0x080E0000, 0x20001, &first, &last), -1);
+    CHECK_EQ(flash_sector_range(0x08004000, 0x100000, &first, &last), -1);
+
+    /*  ,    */
+    CHECK_EQ(flash_sector_range(0x08004000, 0, &first, &last), -1);
+    CHECK_EQ(flash_sector_range(0x08004004, 16, &first, &last), -1);
+    CHECK_EQ(flash_sector_range(0x08100000, 16, &first, &last), -1);
+
+    /* addr + len :      */
+    CHECK_EQ(flash_sector_range(0x08004000, 0xF8000000, &first, &last), -1);
+    CHECK_EQ(flash_sector_range(0x080E0000, 0xFFFFFFFF, &first, &last), -1);
+    CHECK_EQ(flash_sector_range(0x08004000, 0xF7FFC001, &first, &last), -1);
+}
+
+
+static void test_find(void)
+{
+    CHECK_EQ(flash_sector_find(0x08000000), 0);
+    CHECK_EQ(flash_sector_find(0x08013FFF), 4);
+    CHECK_EQ(flash_sector_find(0x080FFFFF), 11);
+    CHECK_EQ(flash_sector_find(0x08100000), -1);
+    CHECK_EQ(flash_sector_find(0x07FFFFFF), -1);
+    CHECK(flash_sector(12) == NULL);
+    CHECK(flash_sector(-1) == NULL);
+}
+
+
+/*         */
+static void test_write(void)
+{
+    static u8 src[1000];
+    int i;
+
+    for (i = 0; i < (int) sizeof(src); i++)
+	src[i] = (u8) (i * 7 + 1);
+    src[100] = 0xFF;
+
+    FLASH_Unlock();
+    CHECK_EQ(flash_erase_sector(1), FLASH_COMPLETE);
+    CHECK_EQ(flash_write(0x08004003, src + 1, 997), FLASH_COMPLETE);
+    FLASH_Lock();
+
+    CHECK(memcmp((const void *) 0x08004003, src + 1, 997) == 0);
+    CHECK_EQ(*(const u8 *) 0x08004002, 0xFF);
+    CHECK_EQ(*(const u8 *) 0x080043E8, 0xFF);
+    CHECK_EQ(sim_stat.erases, 1);
+    CHECK_EQ(sim_stat.flash_errors, 0);
+    CHECK_EQ(sim_stat.overprogram, 0);
+}
+
+
+/*  - :  4 1024 ,   4096 ;
+ *    ( stage) -   */
+static void test_words(void)
+{
+    static u32 src[1024 + 1];
+    u32 programs;
+    int i;
+
+    for (i = 0; i < 1024 + 1; i++)
+	src[i] = (u32) i * 0x01030507 + 0x10203040;
+
+    FLASH_Unlock();
+    CHECK_EQ(flash_erase_sector(2), FLASH_COMPLETE);
+    CHECK_EQ(flash_erase_sector(3), FLASH_COMPLETE);
+    programs = sim_stat.programs;
+    CHECK_EQ(flash_write(0x08008000, src, 4096), FLASH_COMPLETE);
+    CHECK_EQ(sim_stat.programs - programs, 4096 / FLASH_STEP);
+    programs = sim_stat.programs;
+    CHECK_EQ(flash_write(0x0800C000, (const u8 *) src + 1, 4096), FLASH_COMPLETE);
+    CHECK_EQ(sim_stat.programs - programs, 4096 / FLASH_STEP);
+    FLASH_Lock();
+
+    CHECK(memcmp((const void *) 0x08008000, src, 4096) == 0);
+    CHECK(memcmp((const void *) 0x0800C000, (const u8 *) src + 1, 4096) == 0);
+    CHECK_EQ(sim_stat.flash_errors, 0);
+    CHECK_EQ(sim_stat.overprogram, 0);
+}
+
+
+/*      :      */
+static void test_sticky(void)
+{
+    static const u8 src[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    u32 errors = sim_stat.flash_errors;
+
+    FLASH_Unlock();
+    FLASH_STORE(u32, 0x08010000, 0);	/*  PG - PGSERR */
+    CHECK_EQ(sim_stat.flash_errors - errors, 1);
+    CHECK(FLASH->SR & FLASH_FLAG_PGSERR);
+    CHECK_EQ(flash_erase_sector(4), FLASH_COMPLETE);
+    FLASH_STORE(u32, 0x08010000, 0);
+    CHECK_EQ(flash_write(0x08010001, src, sizeof(src)), FLASH_COMPLETE);
+    FLASH_Lock();
+    CHECK(memcmp((const void *) 0x08010001, src, sizeof(src)) == 0);
+}
+
+
+/* FLASH_ProgramByte(),   -   (FLASH_STORE) */
+static FLASH_Status program_byte(u32 addr, u8 v)
+{
+    FLASH_Status status = FLASH_WaitForLastOperation();
+
+    if (status == FLASH_COMPLETE) {
+	FLASH->CR &= CR_PSIZE_MASK;
+	FLASH->CR |= FLASH_PSIZE_BYTE;
+	FLASH->CR |= FLASH_CR_PG;
+	FLASH_STORE(u8, addr, v);
+	status = FLASH_WaitForLastOperation();
+	FLASH->CR &= (~FLASH_CR_PG);
+    }
+    return status;
+}
+
+
+/*     : len    addr  src */
+static double speed(u32 addr, const u8 * src, int len, int bytewise)
+{
+    u64 t = sim_now();
+    int i;
+
+    if (bytewise) {
+	for (i = 0; i < len; i++)
+	    CHECK_EQ(program_byte(addr + i, src[i]), FLASH_COMPLETE);
+    } else {
+	CHECK_EQ(flash_write(addr, src, len), FLASH_COMPLETE);
+    }
+    t = sim_now() - t;
+    CHECK(memcmp((const void *) addr, src, len) == 0);
+    return (double) len * SIM_HZ / (t ? t : 1);
+}
+
+
+/*   - ,  -  stage,  
+ *  -  FLASH_ProgramByte()   ,   */
+static void bench(void)
+{
+    static u32 src[0x10000 / 4 + 1];
+    double a, u, b;
+    int i;
+
+    for (i = 0; i < (int) (sizeof(src) / sizeof(src[0])); i++)
+	src[i] = (u32) i * 0x9E3779B9 + 0x01020304;
+
+    FLASH_Unlock();
+    CHECK_EQ(flash_erase_sector(5), FLASH_COMPLETE);
+    CHECK_EQ(flash_erase_sector(6), FLASH_COMPLETE);
+    CHECK_EQ(flash_erase_sector(7), FLASH_COMPLETE);
+    a = speed(0x08020000, (const u8 *) src, 0x10000, 0);
+    u = speed(0x08040000, (const u8 *) src + 1, 0x10000, 0);
+    b = speed(0x08060000, (const u8 *) src, 0x10000, 1);
+    FLASH_Lock();
+
+    printf("  flash_write x%d, aligned source: %.0f KB/s\n", FLASH_STEP * 8, a / 1024);
+    printf("  flash_write x%d, unaligned source: %.0f KB/s\n", FLASH_STEP * 8, u / 1024);
+    printf("  FLASH_ProgramByte: %.0f KB/s\n", b / 1024);
+    CHECK(a > 3 * b && u > 3 * b);
+}
+
+
+int main(int argc, char **argv)
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "c:")) != -1) {
+	if (c == 'c')
+	    sim.cpu = atof(optarg);
+    }
+    test_board("test_flash");
+    test_range();
+    test_find();
+    test_write();
+    test_words();
+    test_sticky();
+    bench();
+    return test_done("flash");
+}
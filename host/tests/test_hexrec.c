@@ -0,0 +1,276 @@
+/******************************************************************************
+ * hexrec.c:  Intel HEX  S-record,  , ,
+ *    hexrec_scan(),    . 
+ *  -  PC (   )
+ *****************************************************************************/
+#include <time.h>
+#include "test.h"
+#include "../../hexrec.c"
+
+
+/*  04, 00  , 05 (  - ), 01 */
+static const char ihex[] =
+    ":020000040800F2\r\n"
+    ":0440000001020304B2\r\n"
+    ":02400800AABB51\r\n"
+    ":0400000508004101AD\r\n"
+    ":00000001FF\r\n";
+
+/*  02:   0x1000 << 4 */
+static const char ihex_seg[] =
+    ":020000021000EC\n"
+    ":02001000556633\n"
+    ":00000001FF\n";
+
+/* S0 , S1 + S9; S2 + S8; S3 + S7 */
+static const char srec1[] = "S0060000686472BB\r\nS10510000102E7\r\nS9030000FC\r\n";
+static const char srec2[] = "S2060120000304D1\nS804000000FB\n";
+static const char srec3[] = "S308080040000506079D\nS3060800400408A5\nS70500000000FA\n";
+
+
+/*    ,   step  */
+static int scan(const char *text, int step, u32 * lo, u32 * hi)
+{
+    hexrec_t h;
+    const u8 *p = (const u8 *) text, *q;
+    int left = strlen(text), k;
+
+    hexrec_init(&h, 0);
+    while (left > 0) {
+	k = (left < step) ? left : step;
+	q = p;
+	if (hexrec_scan(&h, &q, &k) < 0)
+	    return -1;
+	left -= q - p;
+	p = q;
+	if (h.eof)
+	    break;
+    }
+    k = 0;
+    if (!h.eof && hexrec_scan(&h, &p, &k) < 0)
+	return -1;
+    *lo = h.lo;
+    *hi = h.hi_addr;
+    return 0;
+}
+
+
+/*  :    out,   step,   out_step */
+static int run(const char *text, u32 out, int step, int out_step, u8 * buf, int max)
+{
+    hexrec_t h;
+    const u8 *p = (const u8 *) text;
+    int left = strlen(text), n = 0, k, got;
+
+    hexrec_init(&h, out);
+    while (n < max) {
+	k = (left < step) ? left : step;
+	left -= k;
+	got = hexrec_run(&h, &p, &k, buf + n, (max - n < out_step) ? max - n : out_step);
+	if (got < 0)
+	    return -1;
+	left += k;
+	n += got;
+	if (got == 0 && left == 0)
+	    break;
+    }
+    return n;
+}
+
+
+static void check_run(const char *text, u32 out, const u8 * expect, int len)
+{
+    static const int steps[][2] = { {1000, 1000}, {1, 1}, {1, 3}, {5, 1000}, {7, 2} };
+    u8 buf[64];
+    int i;
+
+    for (i = 0; i < (int) (sizeof(steps) / sizeof(steps[0])); i++) {
+	memset(buf, 0, sizeof(buf));
+	CHECK_EQ(run(text, out, steps[i][0], steps[i][1], buf, sizeof(buf)), len);
+	CHECK(memcmp(buf, expect, len) == 0);
+    }
+}
+
+
+static void test_ihex(void)
+{
+    static const u8 img[] = { 1, 2, 3, 4, 0xFF, 0xFF, 0xFF, 0xFF, 0xAA, 0xBB };
+    static const u8 gap[] = { 0xFF, 0xFF, 1, 2, 3, 4 };
+    static const u8 seg[] = { 0x55, 0x66 };
+    u32 lo, hi;
+
+    CHECK_EQ(scan(ihex, 1000, &lo, &hi), 0);
+    CHECK_EQ(lo, 0x08004000);
+    CHECK_EQ(hi, 0x0800400A);
+    CHECK_EQ(scan(ihex, 1, &lo, &hi), 0);
+    CHECK_EQ(hi, 0x0800400A);
+    check_run(ihex, 0x08004000, img, sizeof(img));
+
+    /*      :   */
+    check_run(":0440000001020304B2\n:00000001FF\n", 0x3FFE, gap, sizeof(gap));
+
+    CHECK_EQ(scan(ihex_seg, 3, &lo, &hi), 0);
+    CHECK_EQ(lo, 0x10010);
+    CHECK_EQ(hi, 0x10012);
+    check_run(ihex_seg, 0x10010, seg, sizeof(seg));
+}
+
+
+static void test_srec(void)
+{
+    static const u8 s1[] = { 1, 2 }, s2[] = { 3, 4 }, s3[] = { 5, 6, 7, 0xFF, 8 };
+    u32 lo, hi;
+
+    CHECK_EQ(scan(srec1, 2, &lo, &hi), 0);
+    CHECK_EQ(lo, 0x1000);
+    CHECK_EQ(hi, 0x1002);
+    check_run(srec1, 0x1000, s1, sizeof(s1));
+
+    CHECK_EQ(scan(srec2, 1000, &lo, &hi), 0);
+    CHECK_EQ(lo, 0x012000);
+    check_run(srec2, 0x012000, s2, sizeof(s2));
+
+    CHECK_EQ(scan(srec3, 1, &lo, &hi), 0);
+    CHECK_EQ(lo, 0x08004000);
+    CHECK_EQ(hi, 0x08004005);
+    check_run(srec3, 0x08004000, s3, sizeof(s3));
+}
+
+
+static void test_errors(void)
+{
+    u8 buf[16];
+    u32 lo, hi;
+
+    /*   */
+    CHECK_EQ(scan(":0440000001020304B3\n:00000001FF\n", 1000, &lo, &hi), -1);
+    CHECK_EQ(run(":0440000001020304B3\n", 0x4000, 1000, 1000, buf, sizeof(buf)), -1);
+    CHECK_EQ(scan("S10510000102E8\nS9030000FC\n", 1000, &lo, &hi), -1);
+
+    /*     */
+    CHECK_EQ(scan(":02400800AABB51\n:0440000001020304B2\n:00000001FF\n", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan(":0440000001020304B2\n:024000000506B3\n:00000001FF\n", 1000, &lo, &hi), -1);
+    CHECK_EQ(run(":02400800AABB51\n:0440000001020304B2\n", 0x4000, 1000, 1000, buf, sizeof(buf)),
+	     -1);
+
+    /*  ,  , ,  , 
+     * ,  hex-.      ,
+     *     : hi_addr == 0 */
+    CHECK_EQ(scan(":0440000001020", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan("", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan(":00000001FF\n", 1000, &lo, &hi), 0);
+    CHECK_EQ(hi, 0);
+    CHECK_EQ(scan(":0440000001020304B2\nx", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan(":0440000001020304B2\nS9030000FC\n", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan(":0440000601020304AC\n", 1000, &lo, &hi), -1);
+    CHECK_EQ(scan(":0440000G01020304B2\n", 1000, &lo, &hi), -1);
+
+    /*       */
+    CHECK_EQ(scan(":0440000001020304B2\n:00000001FF\ngarbage", 1000, &lo, &hi), 0);
+    CHECK_EQ(run(":0440000001020304B2\n:00000001FF\ngarbage", 0x4000, 1000, 1000, buf,
+		 sizeof(buf)), 4);
+}
+
+
+#define BENCH_BASE	0x08004000
+#define BENCH_SIZE	(1 << 20)
+
+static u8 bench_byte(u32 i)
+{
+    return (u8) ((i * 0x9E3779B1) >> 13);
+}
+
+
+/* 1   BENCH_BASE   16 ,   objcopy:
+ * HEX -   04   64, SREC - S3  S7 */
+static int gen(char *text, int fmt)
+{
+    u8 rec[5 + 16];
+    int n = 0, i, j, sum;
+    u32 a;
+
+    for (i = 0; i < BENCH_SIZE; i += 16) {
+	a = BENCH_BASE + i;
+	if (fmt == HEXREC_IHEX && (i == 0 || (a & 0xFFFF) == 0))
+	    n += sprintf(text + n, ":02000004%04X%02X\r\n", (unsigned) (a >> 16),
+			 (unsigned) (-(6 + (a >> 24) + ((a >> 16) & 0xFF)) & 0xFF));
+	if (fmt == HEXREC_IHEX) {
+	    rec[0] = 16;
+	    rec[1] = (u8) (a >> 8);
+	    rec[2] = (u8) a;
+	    rec[3] = 0;
+	    j = 4;
+	    n += sprintf(text + n, ":");
+	} else {
+	    rec[0] = 5 + 16;
+	    rec[1] = (u8) (a >> 24);
+	    rec[2] = (u8) (a >> 16);
+	    rec[3] = (u8) (a >> 8);
+	    rec[4] = (u8) a;
+	    j = 5;
+	    n += sprintf(text + n, "S3");
+	}
+	for (sum = 0; j > 0; j--)
+	    sum += rec[j - 1];
+	for (j = 0; j < 16; j++) {
+	    rec[(fmt == HEXREC_IHEX ? 4 : 5) + j] = bench_byte(i + j);
+	    sum += bench_byte(i + j);
+	}
+	for (j = 0; j < (fmt == HEXREC_IHEX ? 4 : 5) + 16; j++)
+	    n += sprintf(text + n, "%02X", rec[j]);
+	n += sprintf(text + n, "%02X\r\n",
+		     (unsigned) ((fmt == HEXREC_IHEX) ? -sum & 0xFF : ~sum & 0xFF));
+    }
+    n += sprintf(text + n, (fmt == HEXREC_IHEX) ? ":00000001FF\r\n" : "S70500000000FA\r\n");
+    return n;
+}
+
+
+/*  :   4 ( f_read()),   512  */
+static void bench(void)
+{
+    static char text[4 << 20];
+    static const char *name[] = { "", "ihex", "srec" };
+    hexrec_t h;
+    const u8 *p;
+    u8 out[512];
+    clock_t t;
+    int fmt, len, left, k, got, n, i, bad;
+
+    for (fmt = HEXREC_IHEX; fmt <= HEXREC_SREC; fmt++) {
+	len = gen(text, fmt);
+	t = clock();
+	hexrec_init(&h, BENCH_BASE);
+	p = (const u8 *) text;
+	left = len;
+	n = bad = 0;
+	for (;;) {
+	    k = (left < 4096) ? left : 4096;
+	    left -= k;
+	    got = hexrec_run(&h, &p, &k, out, sizeof(out));
+	    if (got < 0)
+		break;
+	    left += k;
+	    for (i = 0; i < got; i++)
+		bad += out[i] != bench_byte(n + i);
+	    n += got;
+	    if (got == 0 && (left == 0 || h.eof))
+		break;
+	}
+	t = clock() - t;
+	CHECK_EQ(n, BENCH_SIZE);
+	CHECK_EQ(bad, 0);
+	printf("  %s, %d byte file on this PC: %.1f MB/s of text\n", name[fmt], len,
+	       len / 1048576.0 * CLOCKS_PER_SEC / (t ? t : 1));
+    }
+}
+
+
+int main(void)
+{
+    test_ihex();
+    test_srec();
+    test_errors();
+    bench();
+    return test_done("hexrec");
+}
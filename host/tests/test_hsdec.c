@@ -0,0 +1,158 @@
+/******************************************************************************
+ * utils/hsdec.c:  heatshrink,    -   .
+ *   -  PC (   )
+ *****************************************************************************/
+#include <time.h>
+#include "test.h"
+#include "../../utils/hsdec.c"
+
+
+/* "abcabcabcabc", -w 8 -l 4:     9   3  */
+static const u8 abc[] = { 0xB0, 0xD8, 0xAC, 0x60, 0x28 };
+
+/* 20 x 'a', -w 8 -l 4:     1  - 16  3  */
+static const u8 aaa[] = { 0xB0, 0x80, 0x3C, 0x00, 0x40 };
+
+/* "abcd" x 9, 'X', "abcd", -w 4 -l 3:   8 ,  -
+ *  5    */
+static const u8 abcd[] = { 0xB0, 0xD8, 0xAC, 0x76, 0x41, 0xF1, 0xF1, 0xF1, 0xFA, 0xC1, 0x18 };
+
+
+/* ,    in_step     out_step */
+static int unpack(int w, int l, const u8 * in, int inlen, int in_step, int out_step,
+		  u8 * out, int outmax)
+{
+    hsdec_t d;
+    const u8 *p;
+    int n = 0, k, got;
+
+    if (!hsdec_init(&d, w, l))
+	return -1;
+    for (p = in; n < outmax; n += got) {
+	k = (in + inlen - p < in_step) ? in + inlen - p : in_step;
+	got = hsdec_run(&d, &p, &k, out + n, (outmax - n < out_step) ? outmax - n : out_step);
+	if (got == 0 && p == in + inlen)
+	    break;
+    }
+    return n;
+}
+
+
+static void check_vector(int w, int l, const u8 * in, int inlen, const char *expect)
+{
+    static const int steps[][2] = { {1000, 1000}, {1, 1}, {1, 7}, {3, 1000}, {2, 5} };
+    u8 out[64];
+    int i, n, len = strlen(expect);
+
+    for (i = 0; i < (int) (sizeof(steps) / sizeof(steps[0])); i++) {
+	memset(out, 0, sizeof(out));
+	n = unpack(w, l, in, inlen, steps[i][0], steps[i][1], out, len);
+	CHECK_EQ(n, len);
+	CHECK(memcmp(out, expect, len) == 0);
+    }
+}
+
+
+static void test_vectors(void)
+{
+    check_vector(8, 4, abc, sizeof(abc), "abcabcabcabc");
+    check_vector(8, 4, aaa, sizeof(aaa), "aaaaaaaaaaaaaaaaaaaa");
+    check_vector(4, 3, abcd, sizeof(abcd), "abcdabcdabcdabcdabcdabcdabcdabcdabcdXabcd");
+}
+
+
+/* - -  :    */
+static void test_tail(void)
+{
+    hsdec_t d;
+    const u8 *p = abc;
+    int k = sizeof(abc);
+    u8 out[32];
+
+    CHECK(hsdec_init(&d, 8, 4));
+    CHECK_EQ(hsdec_run(&d, &p, &k, out, sizeof(out)), 12);
+    CHECK_EQ(k, 0);
+    CHECK_EQ(hsdec_run(&d, &p, &k, out, sizeof(out)), 0);
+}
+
+
+static void test_params(void)
+{
+    hsdec_t d;
+
+    CHECK(hsdec_init(&d, HS_WINDOW_MIN, 3));
+    CHECK(hsdec_init(&d, HS_WINDOW_MAX, HS_WINDOW_MAX - 1));
+    CHECK(!hsdec_init(&d, HS_WINDOW_MIN - 1, 3));
+    CHECK(!hsdec_init(&d, HS_WINDOW_MAX + 1, 4));
+    CHECK(!hsdec_init(&d, 8, 2));
+    CHECK(!hsdec_init(&d, 8, 8));
+}
+
+
+/*     bench():   -  */
+static u8 *put_p;
+static int put_n;
+
+static void put_bits(u32 v, int n)
+{
+    while (n-- > 0) {
+	if (put_n % 8 == 0)
+	    put_p[put_n / 8] = 0;
+	if (v & (1UL << n))
+	    put_p[put_n / 8] |= 0x80 >> (put_n % 8);
+	put_n++;
+    }
+}
+
+
+/*  -w 8 -l 4,   :  ,  - 
+ *  16    .    512 , 
+ *   flash */
+static void bench(void)
+{
+    static u8 in[1 << 20], out[512];
+    hsdec_t d;
+    const u8 *p;
+    u32 seed = 1, total = 0, len = 0, r;
+    clock_t t;
+    int i, k, got;
+
+    put_p = in;
+    put_n = 0;
+    while (put_n / 8 < (int) sizeof(in) - 4) {
+	seed = seed * 1103515245 + 12345;
+	r = seed >> 8;
+	if (len < 256 || r % 3 == 0) {
+	    put_bits(0x100 | (r & 0xFF), 9);
+	    len++;
+	} else {
+	    put_bits((r >> 8) & 0xFF, 9);
+	    put_bits((r >> 16) & 0x0F, 4);
+	    len += ((r >> 16) & 0x0F) + 1;
+	}
+    }
+
+    t = clock();
+    for (i = 0; i < 8; i++) {
+	CHECK(hsdec_init(&d, 8, 4));
+	p = in;
+	k = (put_n + 7) / 8;
+	while ((got = hsdec_run(&d, &p, &k, out, sizeof(out))) > 0)
+	    total += got;
+    }
+    t = clock() - t;
+    CHECK_EQ(total, 8 * len);
+    printf("  heatshrink -w 8 -l 4 on this PC: %.1f MB/s out, %.1f MB/s in\n",
+	   total / 1048576.0 * CLOCKS_PER_SEC / (t ? t : 1),
+	   8.0 * ((put_n + 7) / 8) / 1048576.0 * CLOCKS_PER_SEC / (t ? t : 1));
+}
+
+
+int main(void)
+{
+    test_vectors();
+    test_tail();
+    test_params();
+    bench();
+    return test_done("hsdec");
+}
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * utils/sha256.c:  FIPS 180-2,  ,  .
+ *  -  PC: MB/s ,  x86,  TSC  
+ *****************************************************************************/
+#include <time.h>
+#include "test.h"
+#include "../../utils/sha256.c"
+
+
+/* SHA-256 len ,    step, -  hex */
+static const char *digest(const void *data, int len, int step)
+{
+    static char out[SHA256_SIZE * 2 + 1];
+    const u8 *p = (const u8 *) data;
+    u8 d[SHA256_SIZE];
+    sha256_t s;
+    int i, k;
+
+    sha256_init(&s);
+    for (i = 0; i < len; i += k) {
+	k = (len - i < step) ? len - i : step;
+	sha256_update(&s, p + i, k);
+    }
+    sha256_final(&s, d);
+    for (i = 0; i < SHA256_SIZE; i++)
+	sprintf(out + 2 * i, "%02x", d[i]);
+    return out;
+}
+
+
+static void check_digest(const void *data, int len, const char *expect)
+{
+    static const int steps[] = { 1 << 30, 1, 3, 63, 64, 65 };
+    int i;
+
+    for (i = 0; i < (int) (sizeof(steps) / sizeof(steps[0])); i++)
+	CHECK(strcmp(digest(data, len, steps[i]), expect) == 0);
+}
+
+
+static void test_vectors(void)
+{
+    static const char q448[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    static u8 a[1000000];
+
+    check_digest("", 0, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    check_digest("abc", 3, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    check_digest(q448, strlen(q448),
+		 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    memset(a, 'a', sizeof(a));
+    CHECK(strcmp(digest(a, sizeof(a), 4096),
+		 "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0") == 0);
+    CHECK(strcmp(digest(a, sizeof(a), 1000),
+		 "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0") == 0);
+
+    /*      (55),   (56),   (64) */
+    check_digest(a, 55, "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+    check_digest(a, 56, "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+    check_digest(a, 64, "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+}
+
+
+/*   -      */
+static void test_copy(void)
+{
+    static const char q448[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha256_t s, t;
+    u8 d1[SHA256_SIZE], d2[SHA256_SIZE];
+
+    sha256_init(&s);
+    sha256_update(&s, q448, 20);
+    t = s;
+    sha256_update(&s, q448 + 20, strlen(q448) - 20);
+    sha256_final(&s, d1);
+    sha256_update(&t, q448 + 20, strlen(q448) - 20);
+    sha256_final(&t, d2);
+    CHECK(memcmp(d1, d2, SHA256_SIZE) == 0);
+    CHECK_EQ(d1[0], 0x24);
+    CHECK_EQ(d1[31], 0xC1);
+}
+
+
+/* 8   512 ,      flash */
+static void bench(void)
+{
+    static u8 buf[512];
+    u8 d[SHA256_SIZE];
+    sha256_t s;
+    clock_t t;
+    unsigned long long c = 0;
+    int i, n = 8 << 20;
+
+    for (i = 0; i < (int) sizeof(buf); i++)
+	buf[i] = (u8) (i * 7);
+    t = clock();
+#if defined(__x86_64__) || defined(__i386__)
+    c = __builtin_ia32_rdtsc();
+#endif
+    sha256_init(&s);
+    for (i = 0; i < n; i += sizeof(buf))
+	sha256_update(&s, buf, sizeof(buf));
+    sha256_final(&s, d);
+#if defined(__x86_64__) || defined(__i386__)
+    c = __builtin_ia32_rdtsc() - c;
+#endif
+    t = clock() - t;
+    printf("  sha256 on this PC: %.1f MB/s", 8.0 * CLOCKS_PER_SEC / (t ? t : 1));
+    if (c)
+	printf(", %.1f TSC cycles/byte", (double) c / n);
+    printf("\n");
+}
+
+
+int main(void)
+{
+    test_vectors();
+    test_copy();
+    bench();
+    return test_done("sha256");
+}
@@ -0,0 +1,189 @@
+"""Образ SD карты с FAT16: MBR, один раздел, корневой каталог, имена 8.3.
+
+Файлы можно класть фрагментами (frag=N - кластеры через N свободных),
+чтобы проверить чтение несмежного файла. Читает образ обратно, в том
+числе после того, как загрузчик стер файл.
+"""
+
+import struct
+
+SECTOR = 512
+PART_START = 2048          # Раздел с 1 МБ, как у карт с завода
+RESERVED = 1
+NFATS = 2
+ROOT_ENTRIES = 512
+FREE, EOC = 0x0000, 0xFFFF
+
+
+def name83(name):
+    base, _, ext = name.upper().partition('.')
+    if not base or len(base) > 8 or len(ext) > 3:
+        raise ValueError('not an 8.3 name: %s' % name)
+    return (base.ljust(8) + ext.ljust(3)).encode('ascii')
+
+
+class Fat16:
+    def __init__(self, path, size_mb=64, cluster=4, create=False):
+        self.path = path
+        if create:
+            self._format(size_mb, cluster)
+        with open(path, 'rb') as f:
+            self.img = bytearray(f.read())
+        self.dirty = []            # Записанные данные файлов (off, len)
+        self._parse()
+
+    # -- создание --------------------------------------------------------
+
+    def _format(self, size_mb, cluster):
+        total = size_mb * 2048
+        nsect = total - PART_START
+        nclus = nsect // cluster
+        fatsz = (2 * (nclus + 2) + SECTOR - 1) // SECTOR
+        mbr = bytearray(SECTOR)
+        mbr[446:462] = struct.pack('<B3sB3sII', 0, b'\x00\x02\x00', 0x06,
+                                   b'\xFE\xFF\xFF', PART_START, nsect)
+        mbr[510:512] = b'\x55\xAA'
+        vbr = bytearray(SECTOR)
+        vbr[0:3] = b'\xEB\x3C\x90'
+        vbr[3:11] = b'MSDOS5.0'
+        struct.pack_into('<HBHBHHBHHHII', vbr, 11, SECTOR, cluster, RESERVED,
+                         NFATS, ROOT_ENTRIES, 0, 0xF8, fatsz, 63, 255,
+                         PART_START, nsect)
+        struct.pack_into('<BBBI11s8s', vbr, 36, 0x80, 0, 0x29, 0x12345678,
+                         b'LOADER     ', b'FAT16   ')
+        vbr[510:512] = b'\x55\xAA'
+        with open(self.path, 'wb') as f:
+            f.truncate(total * SECTOR)
+            f.write(mbr)
+            f.seek(PART_START * SECTOR)
+            f.write(vbr)
+            for i in range(NFATS):
+                f.seek((PART_START + RESERVED + i * fatsz) * SECTOR)
+                f.write(struct.pack('<HH', 0xFFF8, 0xFFFF))
+
+    def _parse(self):
+        base = struct.unpack_from('<I', self.img, 446 + 8)[0]
+        (ss, self.spc, res, nfats, nroot, _, _, fatsz, _, _, _,
+         nsect) = struct.unpack_from('<HBHBHHBHHHII', self.img, base * SECTOR + 11)
+        assert ss == SECTOR
+        self.fat = base + res
+        self.fatsz = fatsz
+        self.nfats = nfats
+        self.root = self.fat + nfats * fatsz
+        self.nroot = nroot
+        self.data = self.root + nroot * 32 // SECTOR
+        self.nclus = (base + nsect - self.data) // self.spc
+
+    # -- низкий уровень --------------------------------------------------
+
+    def _get(self, c):
+        return struct.unpack_from('<H', self.img, self.fat * SECTOR + 2 * c)[0]
+
+    def _set(self, c, v):
+        for i in range(self.nfats):
+            struct.pack_into('<H', self.img, (self.fat + i * self.fatsz) * SECTOR + 2 * c, v)
+
+    def cluster_lba(self, c):
+        return self.data + (c - 2) * self.spc
+
+    def _entries(self):
+        for i in range(self.nroot):
+            off = self.root * SECTOR + 32 * i
+            yield off, self.img[off:off + 32]
+
+    def _alloc(self, n, frag):
+        """n свободных кластеров; frag - пропуск между ними"""
+        out, c = [], 2
+        while len(out) < n:
+            if c >= self.nclus + 2:
+                raise RuntimeError('disk full')
+            if self._get(c) == FREE:
+                out.append(c)
+                c += 1 + frag
+            else:
+                c += 1
+        return out
+
+    # -- файлы -----------------------------------------------------------
+
+    def add(self, name, data, frag=0, skip=0):
+        """Файл в корневой каталог: skip пустых записей каталога перед ним"""
+        raw = name83(name)
+        if self.find(name) is not None:
+            self.remove(name)
+        csize = self.spc * SECTOR
+        clus = self._alloc((len(data) + csize - 1) // csize, frag) if data else []
+        for i, c in enumerate(clus):
+            self._set(c, clus[i + 1] if i + 1 < len(clus) else EOC)
+            lba = self.cluster_lba(c)
+            chunk = data[i * csize:(i + 1) * csize]
+            self.img[lba * SECTOR:lba * SECTOR + len(chunk)] = chunk
+            self.dirty.append((lba * SECTOR, len(chunk)))
+        for off, e in self._entries():
+            if e[0] in (0x00, 0xE5):
+                if skip:
+                    # Занятая удаленная запись: до нее FatFs проходит мимо
+                    self.img[off] = 0xE5
+                    skip -= 1
+                    continue
+                ent = struct.pack('<11sBBBHHHHHHHI', raw, 0x20, 0, 0, 0, 0x21, 0x21, 0,
+                                  0, 0x21, clus[0] if clus else 0, len(data))
+                self.img[off:off + 32] = ent
+                return clus
+        raise RuntimeError('root directory full')
+
+    def find(self, name):
+        raw = name83(name)
+        for off, e in self._entries():
+            if e[0] == 0x00:
+                return None
+            if e[0] != 0xE5 and e[:11] == raw and not e[11] & 0x08:
+                return off
+        return None
+
+    def chain(self, c):
+        out = []
+        while 2 <= c < 0xFFF8:
+            out.append(c)
+            c = self._get(c)
+        return out
+
+    def read(self, name):
+        off = self.find(name)
+        if off is None:
+            return None
+        first, size = struct.unpack_from('<HI', self.img, off + 26)
+        out = bytearray()
+        for c in self.chain(first):
+            lba = self.cluster_lba(c)
+            out += self.img[lba * SECTOR:(lba + self.spc) * SECTOR]
+        return bytes(out[:size])
+
+    def remove(self, name):
+        off = self.find(name)
+        if off is None:
+            return
+        first = struct.unpack_from('<H', self.img, off + 26)[0]
+        for c in self.chain(first):
+            self._set(c, FREE)
+        self.img[off] = 0xE5
+
+    def names(self):
+        out = []
+        for _, e in self._entries():
+            if e[0] == 0x00:
+                break
+            if e[0] != 0xE5 and not e[11] & 0x08:
+                base, ext = e[:8].decode().rstrip(), e[8:11].decode().rstrip()
+                out.append(base + ('.' + ext if ext else ''))
+        return out
+
+    def save(self):
+        """Назад в файл только служебную область и данные новых файлов"""
+        with open(self.path, 'r+b') as f:
+            f.seek(0)
+            f.write(self.img[:self.data * SECTOR])
+            for off, n in self.dirty:
+                f.seek(off)
+                f.write(self.img[off:off + n])
+        self.dirty = []
@@ -0,0 +1,370 @@
+#!/usr/bin/env python3
+"""Образ для загрузчика: заголовок image_header_t (image.h) и данные.
+
+  mkimage.py app.bin loader.bin --addr 0x08004000 [--sha256] [--version N]
+  mkimage.py new.bin loader.bin --addr 0x08004000 --delta old.bin
+  mkimage.py app.bin loader.bin --addr 0x08004000 --hs 8,4
+  mkimage.py app.bin loader.bin --addr 0x08004000 --sign key.bin --aes aes.key
+
+Без --addr пишется сырой образ (без заголовка), как раньше.
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import sys
+
+IMAGE_MAGIC = 0x3152444C
+IMAGE_HDR_VERSION = 1
+APP_ADDRESS = 0x08004000
+
+FLAG_DATA = 0x00000001
+FLAG_HS = 0x00000002
+FLAG_DELTA = 0x00000004
+FLAG_SPARSE = 0x00000008
+FLAG_SHA256 = 0x00000040
+FLAG_SIGNED = 0x00000080
+FLAG_AES = 0x00010000
+
+RUN_ERASED = 0x80000000
+DELTA_MAGIC = 0x31544C44
+
+# Ключи тестовой сборки (tests/keys.mk): RFC 8032, 7.1 TEST 1
+TEST_SIGN_KEY = bytes.fromhex('9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60')
+# FIPS-197, приложение A.1
+TEST_AES_KEY = bytes.fromhex('2b7e151628aed2a6abf7158809cf4f3c')
+
+HDR_FMT = '<IHHIIIIIII'
+HDR_LEN = struct.calcsize(HDR_FMT)
+
+
+def _crc_table():
+    t = []
+    for i in range(256):
+        c = i << 24
+        for _ in range(8):
+            c = ((c << 1) ^ 0x04C11DB7) if c & 0x80000000 else c << 1
+        t.append(c & 0xFFFFFFFF)
+    return t
+
+
+CRC_TABLE = _crc_table()
+
+
+def crc32_stm(data, c=0xFFFFFFFF):
+    """CRC-32 блока CRC STM32 (crc32.h): словами, хвост дополнен 0xFF"""
+    data = bytes(data)
+    if len(data) % 4:
+        data += b'\xFF' * (4 - len(data) % 4)
+    t = CRC_TABLE
+    be = bytearray(len(data))
+    be[0::4], be[1::4], be[2::4], be[3::4] = data[3::4], data[2::4], data[1::4], data[0::4]
+    for b in be:
+        c = ((c << 8) & 0xFFFFFFFF) ^ t[(c >> 24) ^ b]
+    return c
+
+
+def header(size, addr, entry, crc, flags, version, hdr_size=512):
+    h = struct.pack(HDR_FMT[:-1], IMAGE_MAGIC, IMAGE_HDR_VERSION, hdr_size,
+                    size, addr, entry, crc, flags, version)
+    return h + struct.pack('<I', crc32_stm(h))
+
+
+def sparse(data, min_run=64):
+    """Записи IMAGE_FLAG_SPARSE: отрезки 0xFF длиннее min_run - без данных"""
+    out, i, n = bytearray(), 0, len(data)
+    while i < n:
+        j = i
+        while j < n and data[j] == 0xFF:
+            j += 1
+        if j - i >= min_run or j == n:
+            out += struct.pack('<I', RUN_ERASED | (j - i))
+            i = j
+            continue
+        j = i
+        while j < n:
+            k = j
+            while k < n and data[k] == 0xFF:
+                k += 1
+            if k - j >= min_run or k == n:
+                break
+            j = k + 1
+        out += struct.pack('<I', j - i) + data[i:j]
+        i = j
+    return bytes(out)
+
+
+def delta(old, new):
+    """Патч (delta.h) к old на месте: разность там, где old есть, дальше -
+    новые байты. Старый байт берется с того же адреса, что и новый, так что
+    правило "не раньше текущего сектора" выполняется само"""
+    old, new = bytes(old), bytes(new)
+    n = min(len(old), len(new))
+    diff = bytes((new[i] - old[i]) & 0xFF for i in range(n))
+    return (struct.pack('<III', DELTA_MAGIC, len(old), crc32_stm(old)) +
+            struct.pack('<IIi', n, len(new) - n, 0) + diff + new[n:])
+
+
+def heatshrink(data, w=8, l=4):
+    """Сжатие heatshrink (hsdec.h): бит 1 + байт - литерал, бит 0 + w бит
+    (смещение - 1) + l бит (длина - 1) - повтор. Жадно, по цепочкам
+    трехбайтовых префиксов; ссылок до начала данных не делает"""
+    data = bytes(data)
+    n, win, longest = len(data), 1 << w, 1 << l
+    acc, nbits, out = 0, 0, bytearray()
+    chains = {}
+
+    def put(v, k):
+        nonlocal acc, nbits
+        acc = (acc << k) | v
+        nbits += k
+        while nbits >= 8:
+            nbits -= 8
+            out.append((acc >> nbits) & 0xFF)
+        acc &= (1 << nbits) - 1
+
+    def add(j):
+        if j + 3 <= n:
+            chains.setdefault(data[j:j + 3], []).append(j)
+
+    i = 0
+    while i < n:
+        best, off = 0, 0
+        for j in reversed(chains.get(data[i:i + 3], [])[-32:]):
+            if i - j > win:
+                break
+            k = 0
+            while k < longest and i + k < n and data[j + k] == data[i + k]:
+                k += 1
+            if k > best:
+                best, off = k, i - j
+        if best * 9 > 1 + w + l:
+            put((off - 1) << l | (best - 1), 1 + w + l)
+            step = best
+        else:
+            put(0x100 | data[i], 9)
+            step = 1
+        for j in range(i, i + step):
+            add(j)
+        i += step
+    if nbits:
+        put(0, 8 - nbits)
+    return bytes(out)
+
+
+# Ed25519 (RFC 8032, 5.1): только подпись, по образцу из раздела 6
+ED_P = 2 ** 255 - 19
+ED_L = 2 ** 252 + 27742317777372353535851937790883648493
+ED_D = -121665 * pow(121666, ED_P - 2, ED_P) % ED_P
+ED_G = (15112221349535400772501151409588531511454012693041857206046113283949847762202,
+        46316835694926478169428394003475163141307993866256225615783033603165251855960,
+        1, 46827403850823179245072216630277197565144205554125654976674165829533817101731)
+
+
+def _ed_add(P, Q):
+    A = (P[1] - P[0]) * (Q[1] - Q[0]) % ED_P
+    B = (P[1] + P[0]) * (Q[1] + Q[0]) % ED_P
+    C = 2 * P[3] * Q[3] * ED_D % ED_P
+    D = 2 * P[2] * Q[2] % ED_P
+    E, F, G, H = B - A, D - C, D + C, B + A
+    return (E * F % ED_P, G * H % ED_P, F * G % ED_P, E * H % ED_P)
+
+
+def _ed_mul(s, P):
+    Q = (0, 1, 1, 0)
+    while s:
+        if s & 1:
+            Q = _ed_add(Q, P)
+        P = _ed_add(P, P)
+        s >>= 1
+    return Q
+
+
+def _ed_pack(P):
+    zi = pow(P[2], ED_P - 2, ED_P)
+    x, y = P[0] * zi % ED_P, P[1] * zi % ED_P
+    return int.to_bytes(y | (x & 1) << 255, 32, 'little')
+
+
+def _ed_expand(secret):
+    h = hashlib.sha512(secret).digest()
+    a = int.from_bytes(h[:32], 'little') & ~7 & ((1 << 254) - 1) | (1 << 254)
+    return a, h[32:]
+
+
+def ed25519_public(secret):
+    return _ed_pack(_ed_mul(_ed_expand(secret)[0], ED_G))
+
+
+def ed25519_sign(secret, msg):
+    """Подпись msg закрытым ключом secret (32 байта)"""
+    a, prefix = _ed_expand(secret)
+    A = _ed_pack(_ed_mul(a, ED_G))
+    r = int.from_bytes(hashlib.sha512(prefix + msg).digest(), 'little') % ED_L
+    R = _ed_pack(_ed_mul(r, ED_G))
+    k = int.from_bytes(hashlib.sha512(R + A + msg).digest(), 'little') % ED_L
+    return R + int.to_bytes((r + k * a) % ED_L, 32, 'little')
+
+
+# AES (FIPS-197) для шифрования образа в режиме CTR, как aes.c
+def _aes_sbox():
+    """S-блок: p проходит GF(2^8) умножением на 3, q = 1/p, затем
+    аффинное преобразование"""
+    sbox, p, q = [0] * 256, 1, 1
+    while True:
+        p = p ^ (p << 1) ^ (0x1B if p & 0x80 else 0)
+        p &= 0xFF
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        x = q ^ (q << 1 | q >> 7) ^ (q << 2 | q >> 6) ^ (q << 3 | q >> 5) ^ (q << 4 | q >> 4)
+        sbox[p] = (x ^ 0x63) & 0xFF
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    return sbox
+
+
+AES_SBOX = _aes_sbox()
+
+
+def _xtime(a):
+    return ((a << 1) ^ (0x1B if a & 0x80 else 0)) & 0xFF
+
+
+def aes_expand(key):
+    nk = len(key) // 4
+    rounds = nk + 6
+    w = [list(key[4 * i:4 * i + 4]) for i in range(nk)]
+    rcon = 1
+    for i in range(nk, 4 * (rounds + 1)):
+        t = list(w[i - 1])
+        if i % nk == 0:
+            t = [AES_SBOX[b] for b in t[1:] + t[:1]]
+            t[0] ^= rcon
+            rcon = _xtime(rcon)
+        elif nk > 6 and i % nk == 4:
+            t = [AES_SBOX[b] for b in t]
+        w.append([a ^ b for a, b in zip(w[i - nk], t)])
+    return [sum(w[4 * r:4 * r + 4], []) for r in range(rounds + 1)]
+
+
+def aes_encrypt_block(rk, block):
+    s = [a ^ b for a, b in zip(block, rk[0])]
+    for r in range(1, len(rk)):
+        s = [AES_SBOX[b] for b in s]
+        s = [s[(i + 4 * (i % 4)) % 16] for i in range(16)]
+        if r < len(rk) - 1:
+            m = []
+            for c in range(4):
+                a = s[4 * c:4 * c + 4]
+                t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                m += [a[i] ^ t ^ _xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)]
+            s = m
+        s = [a ^ b for a, b in zip(s, rk[r])]
+    return bytes(s)
+
+
+def aes_ctr(key, iv, data):
+    """AES-CTR: счетчик - iv + номер блока, 128 бит big-endian (как в OpenSSL)"""
+    rk = aes_expand(key)
+    ctr = int.from_bytes(iv, 'big')
+    out = bytearray(data)
+    for i in range(0, len(out), 16):
+        ks = aes_encrypt_block(rk, ((ctr + i // 16) % (1 << 128)).to_bytes(16, 'big'))
+        for j in range(min(16, len(out) - i)):
+            out[i + j] ^= ks[j]
+    return bytes(out)
+
+
+def build(data, addr=None, entry=None, version=0, sha=False, is_data=False,
+          sparse_min=0, hdr_size=512, base=None, hs=None, sign=None, aes=None, iv=None):
+    """Файл образа; addr=None - сырой, base - патч к этой прошивке,
+    hs=(w, l) - данные (и патч) сжать heatshrink, sign - закрытый ключ
+    Ed25519 (подпись заголовка с SHA-256, SHA-256 тогда пишется всегда),
+    aes - ключ AES-CTR для всего после заголовка, iv - начальный
+    счетчик (по умолчанию случайный)"""
+    if addr is None:
+        return bytes(data)
+    flags = (FLAG_DATA if is_data else 0)
+    payload = bytes(data)
+    if sparse_min:
+        flags |= FLAG_SPARSE
+        payload = sparse(data, sparse_min)
+    if base is not None:
+        flags |= FLAG_DELTA
+        payload = delta(base, data)
+    if hs is not None:
+        flags |= FLAG_HS | hs[0] << 8 | hs[1] << 12
+        payload = heatshrink(payload, *hs)
+    if aes is not None:
+        flags |= FLAG_AES
+    if sign is not None:
+        flags |= FLAG_SHA256 | FLAG_SIGNED
+    elif sha:
+        flags |= FLAG_SHA256
+    h = header(len(data), addr, addr if entry is None else entry,
+               crc32_stm(data), flags, version, hdr_size)
+    head = h
+    if flags & FLAG_SHA256:
+        head += hashlib.sha256(data).digest()
+    if sign is not None:
+        head += ed25519_sign(sign, head)
+    if aes is not None:
+        iv = os.urandom(16) if iv is None else iv
+        head += iv
+        payload = aes_ctr(aes, iv, payload)
+    return head + b'\xFF' * (hdr_size - len(head)) + payload
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input')
+    ap.add_argument('output')
+    ap.add_argument('--addr', type=lambda x: int(x, 0))
+    ap.add_argument('--entry', type=lambda x: int(x, 0))
+    ap.add_argument('--version', type=lambda x: int(x, 0), default=0)
+    ap.add_argument('--sha256', action='store_true')
+    ap.add_argument('--data', action='store_true', help='не приложение')
+    ap.add_argument('--sparse', type=int, default=0, metavar='MIN',
+                    help='отрезки 0xFF от MIN байт не хранить')
+    ap.add_argument('--delta', metavar='BASE', help='патч к прошивке BASE')
+    ap.add_argument('--sign', metavar='KEY',
+                    help='подписать: файл с закрытым ключом Ed25519 (32 байта) или test')
+    ap.add_argument('--aes', metavar='KEY',
+                    help='зашифровать AES-CTR: файл с ключом (16, 24, 32 байта) или test')
+    ap.add_argument('--hs', metavar='W,L', type=lambda x: tuple(int(v) for v in x.split(',')),
+                    help='сжать heatshrink с окном 2^W и повтором до 2^L')
+    a = ap.parse_args()
+    with open(a.input, 'rb') as f:
+        data = f.read()
+    base = None
+    if a.delta:
+        with open(a.delta, 'rb') as f:
+            base = f.read()
+    sign = None
+    if a.sign == 'test':
+        sign = TEST_SIGN_KEY
+    elif a.sign:
+        with open(a.sign, 'rb') as f:
+            sign = f.read(32)
+    aes = None
+    if a.aes == 'test':
+        aes = TEST_AES_KEY
+    elif a.aes:
+        with open(a.aes, 'rb') as f:
+            aes = f.read()
+    out = build(data, a.addr, a.entry, a.version, a.sha256, a.data, a.sparse,
+                base=base, hs=a.hs, sign=sign, aes=aes)
+    with open(a.output, 'wb') as f:
+        f.write(out)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,765 @@
+/******************************************************************************
+ *   : ,     ,
+ *    
+ *****************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include "image.h"
+#include "update.h"
+#include "crc32.h"
+#include "hsdec.h"
+#include "delta.h"
+#include "hexrec.h"
+#include "elf.h"
+#include "sha256.h"
+#include "ed25519.h"
+#include "aes.h"
+#include "diskio.h"
+#include "systick.h"
+
+
+/*   :        */
+static struct {
+    FIL *fil;
+    u32 data;			/*     */
+    u32 load;			/*    */
+    int hs;			/*   */
+    int delta;			/*  */
+    int sparse;			/*   */
+    int text;			/* HEX/SREC */
+    int elf;			/* ELF32 */
+    int aes;			/*  */
+    u32 mark;			/*      */
+    u32 read;			/*   ,   */
+    DWORD lba;			/*  :   ,  0 */
+    u32 direct;			/*   FatFs,  disk_read() */
+    u32 copied;			/*  f_read()   FatFs */
+    u32 sha_cycles;		/*   SHA-256 */
+    u32 aes_cycles;		/*    */
+} src;
+
+/*  :  ,        
+ * (   -   image_forward()    CRC).
+ *   -   */
+static hsdec_t dec, dec_mark;
+static u32 in_buf[IMAGE_READ_SIZE / 4];
+static const u8 *in_p;
+static int in_n;
+
+/* :        */
+static delta_t dlt, dlt_mark;
+
+/*  :         */
+typedef struct {
+    u32 left;
+    int erased;
+} run_t;
+static run_t run, run_mark;
+
+/* HEX/SREC:        */
+static hexrec_t hx, hx_mark;
+
+/* ELF:     ,    */
+static elf_t elf, elf_mark;
+
+/* image_forward(): ,      ,
+ *    ( in_buf  ) */
+static struct {
+    image_sink_t sink;
+    int ok;
+    int n;
+} fwd;
+static u32 out_buf[IMAGE_READ_SIZE / 4];
+
+/* SHA-256        */
+static sha256_t sha, sha_mark;
+
+/*   SHA-256    (  )   */
+static struct {
+    image_header_t hdr;
+    u8 digest[SHA256_SIZE];
+} signed_part;
+static u8 signature[ED25519_SIG_SIZE];
+static int has_expect, has_sig;
+
+/*  :   ,  -  update.h */
+static aes_t aes;
+#ifdef UPDATE_AES_KEY
+static u8 aes_iv[16];
+static const u8 aes_key[] = UPDATE_AES_KEY;
+#endif
+
+static int data_read(void *, int);
+static int file_read(void *, int);
+static u32 window_bytes(u32, u32);
+static int sparse_read(u8 *, int);
+static int name_kind(const char *);
+static int text_scan(FIL *, image_header_t *);
+static int elf_scan(FIL *, image_header_t *);
+static int elf_read(u8 *, int);
+static UINT forward_window(const BYTE *, UINT);
+
+
+/**
+ *      name.
+ *  -    (name_kind),    .
+ *       hdr ,   
+ * :    APP_ADDRESS, CRC .
+ *       
+ */
+int image_read_header(FIL * fil, const char *name, image_header_t * hdr)
+{
+    unsigned br = 0;
+    u32 fsize = f_size(fil);
+    int first, last;
+
+    memset(hdr, 0, sizeof(*hdr));
+    has_expect = has_sig = 0;
+    switch (name_kind(name)) {
+    case IMAGE_TEXT:
+	return text_scan(fil, hdr);
+    case IMAGE_ELF:
+	return elf_scan(fil, hdr);
+    }
+
+    if (f_lseek(fil, 0) != FR_OK)
+	return IMAGE_BAD;
+    if (fsize >= sizeof(*hdr) && f_read(fil, hdr, sizeof(*hdr), &br) != FR_OK)
+	return IMAGE_BAD;
+
+    if (br != sizeof(*hdr) || hdr->magic != IMAGE_MAGIC) {
+	/*   */
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->size = fsize;
+	hdr->load_addr = APP_ADDRESS;
+	hdr->entry = APP_ADDRESS;
+	return (f_lseek(fil, 0) == FR_OK) ? IMAGE_RAW : IMAGE_BAD;
+    }
+
+    crc32_reset();
+    crc32_update(hdr, offsetof(image_header_t, hdr_crc));
+    if (crc32_get() != hdr->hdr_crc)
+	return IMAGE_BAD;
+
+    if (hdr->hdr_version != IMAGE_HDR_VERSION ||
+	hdr->hdr_size < sizeof(*hdr) || hdr->hdr_size > fsize)
+	return IMAGE_BAD;
+
+    /*       flash    
+     * (load_addr + size   -  ) */
+    if (flash_sector_range(hdr->load_addr, hdr->size, &first, &last) < 0)
+	return IMAGE_BAD;
+
+    /*  ,        -
+     *    .       */
+    if ((hdr->flags & IMAGE_FLAG_DELTA) && (hdr->flags & IMAGE_FLAG_SPARSE))
+	return IMAGE_BAD;
+    if (hdr->flags & (IMAGE_FLAG_TEXT | IMAGE_FLAG_ELF))
+	return IMAGE_BAD;
+    if (hdr->flags & IMAGE_FLAG_HS) {
+	if (!hsdec_init(&dec, IMAGE_HS_W(hdr->flags), IMAGE_HS_L(hdr->flags)))
+	    return IMAGE_BAD;
+    } else if (!(hdr->flags & (IMAGE_FLAG_DELTA | IMAGE_FLAG_SPARSE)) &&
+	       hdr->size > fsize - hdr->hdr_size) {
+	return IMAGE_BAD;
+    }
+
+    /*         ( ),
+     *        */
+    if (!(hdr->flags & IMAGE_FLAG_DATA) &&
+	(!UPDATE_IS_ENTRY(hdr->entry) || hdr->entry < hdr->load_addr ||
+	 hdr->entry - hdr->load_addr >= hdr->size))
+	return IMAGE_BAD;
+
+    /*     */
+    if (hdr->load_addr < UPDATE_MIN_ADDRESS)
+	return IMAGE_BAD;
+
+    /* SHA-256   -    */
+    signed_part.hdr = *hdr;
+    if (hdr->flags & IMAGE_FLAG_SHA256) {
+	if (hdr->hdr_size < sizeof(signed_part) ||
+	    f_read(fil, signed_part.digest, SHA256_SIZE, &br) != FR_OK || br != SHA256_SIZE)
+	    return IMAGE_BAD;
+	has_expect = 1;
+    }
+    if (hdr->flags & IMAGE_FLAG_SIGNED) {
+	if (!has_expect || hdr->hdr_size < sizeof(signed_part) + sizeof(signature) ||
+	    f_read(fil, signature, sizeof(signature), &br) != FR_OK || br != sizeof(signature))
+	    return IMAGE_BAD;
+	has_sig = 1;
+    }
+    if (hdr->flags & IMAGE_FLAG_AES) {
+#ifndef UPDATE_AES_KEY
+	return IMAGE_BAD;
+#else
+	if (f_tell(fil) + sizeof(aes_iv) > hdr->hdr_size ||
+	    f_read(fil, aes_iv, sizeof(aes_iv), &br) != FR_OK || br != sizeof(aes_iv))
+	    return IMAGE_BAD;
+#endif
+    }
+
+    return (f_lseek(fil, hdr->hdr_size) == FR_OK) ? IMAGE_VALID : IMAGE_BAD;
+}
+
+
+/**
+ *    : .hex, .s19, .srec - IMAGE_TEXT,
+ * .elf - IMAGE_ELF,  -   (IMAGE_RAW):  
+ *  .    
+ */
+static int name_kind(const char *name)
+{
+    static const struct {
+	char ext[5];
+	int kind;
+    } exts[] = {
+	{"HEX", IMAGE_TEXT}, {"S19", IMAGE_TEXT}, {"SREC", IMAGE_TEXT}, {"ELF", IMAGE_ELF}
+    };
+    const char *e = strrchr(name, '.');
+    int i, j;
+
+    if (e == NULL)
+	return IMAGE_RAW;
+    for (i = 0; i < (int) (sizeof(exts) / sizeof(exts[0])); i++) {
+	for (j = 0; exts[i].ext[j] && toupper((u8) e[1 + j]) == exts[i].ext[j]; j++);
+	if (!exts[i].ext[j] && !e[1 + j])
+	    return exts[i].kind;
+    }
+    return IMAGE_RAW;
+}
+
+
+/**
+ * HEX/SREC:        - 
+ *     ,   .
+ *     ,     
+ */
+static int text_scan(FIL * fil, image_header_t * hdr)
+{
+    const flash_sector_t *sec;
+    unsigned br;
+
+    hexrec_init(&hx, 0);
+    if (f_lseek(fil, 0) != FR_OK)
+	return IMAGE_BAD;
+    do {
+	if (f_read(fil, in_buf, sizeof(in_buf), &br) != FR_OK)
+	    return IMAGE_BAD;
+	in_p = (const u8 *) in_buf;
+	in_n = br;
+	if (hexrec_scan(&hx, &in_p, &in_n) < 0)
+	    return IMAGE_BAD;
+    } while (br > 0);
+
+    sec = flash_sector(flash_sector_find(hx.lo));
+    if (sec == NULL || hx.lo < UPDATE_MIN_ADDRESS)
+	return IMAGE_BAD;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->load_addr = sec->addr;
+    hdr->size = hx.hi_addr - sec->addr;
+    hdr->entry = APP_ADDRESS;
+    hdr->flags = IMAGE_FLAG_TEXT;
+    return (f_lseek(fil, 0) == FR_OK) ? IMAGE_TEXT : IMAGE_BAD;
+}
+
+
+/**
+ * ELF32:       ,
+ *    PT_LOAD -   HEX,   
+ */
+static int elf_scan(FIL * fil, image_header_t * hdr)
+{
+    const flash_sector_t *sec;
+    elf_ehdr_t eh;
+    unsigned br;
+    u32 lo, hi;
+
+    if (f_lseek(fil, 0) != FR_OK || f_read(fil, &eh, sizeof(eh), &br) != FR_OK ||
+	br != sizeof(eh) || eh.e_phnum > ELF_PHNUM_MAX ||
+	f_lseek(fil, eh.e_phoff) != FR_OK ||
+	f_read(fil, in_buf, eh.e_phnum * sizeof(elf_phdr_t), &br) != FR_OK ||
+	br != eh.e_phnum * sizeof(elf_phdr_t) ||
+	!elf_init(&elf, &eh, (const elf_phdr_t *) in_buf))
+	return IMAGE_BAD;
+
+    lo = elf.seg[0].addr;
+    hi = elf.seg[elf.nseg - 1].addr + elf.seg[elf.nseg - 1].size;
+    sec = flash_sector(flash_sector_find(lo));
+    if (sec == NULL || lo < UPDATE_MIN_ADDRESS)
+	return IMAGE_BAD;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->load_addr = sec->addr;
+    hdr->size = hi - sec->addr;
+    hdr->entry = APP_ADDRESS;
+    hdr->flags = IMAGE_FLAG_ELF;
+    return IMAGE_ELF;
+}
+
+
+/**
+ *    .      .
+ *   ,     ,   .
+ * resume -         :
+ *        ,   
+ */
+int image_open(FIL * fil, const image_header_t * hdr, int resume)
+{
+    delta_header_t dh;
+    int first, last;
+
+    memset(&src, 0, sizeof(src));
+    src.fil = fil;
+    src.data = hdr->hdr_size;
+    src.load = hdr->load_addr;
+    src.hs = (hdr->flags & IMAGE_FLAG_HS) != 0;
+    src.sparse = (hdr->flags & IMAGE_FLAG_SPARSE) != 0;
+    src.text = (hdr->flags & IMAGE_FLAG_TEXT) != 0;
+    src.elf = (hdr->flags & IMAGE_FLAG_ELF) != 0;
+    src.aes = (hdr->flags & IMAGE_FLAG_AES) != 0;
+    in_n = 0;
+    memset(&run, 0, sizeof(run));
+    sha256_init(&sha);
+
+    if (src.hs && !hsdec_init(&dec, IMAGE_HS_W(hdr->flags), IMAGE_HS_L(hdr->flags)))
+	return 0;
+    /*    (      ) 
+     *   ,  FatFs */
+    if (f_contiguous(fil, &src.lba) != FR_OK)
+	src.lba = 0;
+
+#ifdef UPDATE_AES_KEY
+    if (src.aes && !aes_init(&aes, aes_key, sizeof(aes_key), aes_iv))
+	return 0;
+#endif
+    if (src.text)
+	hexrec_init(&hx, hdr->load_addr);
+    if (src.elf)
+	elf_start(&elf, hdr->load_addr);
+
+    if (hdr->flags & IMAGE_FLAG_DELTA) {
+	if (data_read(&dh, sizeof(dh)) != sizeof(dh) ||
+	    !delta_start(&dlt, data_read, hdr->load_addr, &dh))
+	    return 0;
+	if (flash_sector_range(hdr->load_addr, dh.base_size, &first, &last) < 0)
+	    return 0;
+
+	if (!resume) {
+	    flash_cache_flush();
+	    crc32_reset();
+	    crc32_update((const void *) hdr->load_addr, dh.base_size);
+	    if (crc32_get() != dh.base_crc)
+		return 0;
+	}
+	src.delta = 1;
+    }
+
+    image_mark();
+    return 1;
+}
+
+
+/**
+ *  len    buf.
+ *    ( len -  ), -1 - .
+ *      SHA-256 -     
+ */
+int image_read(void *buf, int len)
+{
+    u32 t;
+    int n;
+
+    if (src.delta)
+	n = delta_read(&dlt, (u8 *) buf, len);
+    else if (src.sparse)
+	n = sparse_read((u8 *) buf, len);
+    else if (src.elf)
+	n = elf_read((u8 *) buf, len);
+    else
+	n = data_read(buf, len);
+
+    if (n > 0) {
+	t = DWT_CYCCNT;
+	sha256_update(&sha, buf, n);
+	src.sha_cycles += DWT_CYCCNT - t;
+    }
+    return n;
+}
+
+
+/**
+ *   len    sink,    
+ * .       
+ *    in_buf  ,   
+ * (disk_read_forward),   -     FatFs
+ * (f_forward).
+ *   -  image_read()  out_buf.  
+ * 0 -   .
+ *    , -1 -  
+ */
+int image_forward(u32 len, image_sink_t sink)
+{
+    unsigned br;
+    u32 pos, n;
+    int k;
+
+    fwd.sink = sink;
+    fwd.ok = 1;
+    fwd.n = 0;
+
+    /*  -    : CRC  ,
+     *         */
+    if (src.hs || src.text || src.delta || src.sparse || src.elf || src.aes || (src.data & 3)) {
+	while (len > 0 && fwd.ok) {
+	    k = image_read(out_buf, (len < sizeof(out_buf)) ? len : sizeof(out_buf));
+	    if (k < 0)
+		return -1;
+	    if (k == 0)
+		break;
+	    fwd.ok = sink((const u8 *) out_buf, k);
+	    if (fwd.ok)
+		fwd.n += k;
+	    len -= k;
+	}
+	return fwd.n;
+    }
+
+    while (len > 0 && fwd.ok) {
+	pos = f_tell(src.fil);
+	n = (f_size(src.fil) - pos < len) ? f_size(src.fil) - pos : len;
+	n &= ~(_MAX_SS - 1);
+	if (src.lba && pos % _MAX_SS == 0 && n > 0) {
+	    /*     -    
+	     * in_buf,   ,   ;
+	     *  FatFs    FAT */
+	    if (n > sizeof(in_buf))
+		n = sizeof(in_buf);
+	    if (disk_read_forward(src.fil->fs->drv, (BYTE *) in_buf, src.lba + pos / _MAX_SS,
+				  n / _MAX_SS, forward_window, &br) != RES_OK ||
+		f_lseek(src.fil, pos + br) != FR_OK)
+		return -1;
+	    src.read += br;
+	    src.direct += br;
+	    len -= br;
+	} else {
+	    n = _MAX_SS - pos % _MAX_SS;
+	    /*    -  ,     */
+	    if (!src.lba || n > len)
+		n = len;
+	    if (f_forward(src.fil, forward_window, n, &br) != FR_OK)
+		return -1;
+	    src.read += br;
+	    if (br == 0)
+		break;		/*   */
+	    len -= br;
+	}
+    }
+    return fwd.n;
+}
+
+
+/*    image_forward():   -  SHA-256 */
+static UINT forward_window(const BYTE * p, UINT n)
+{
+    u32 t;
+
+    if (n == 0)			/* f_forward() ,    */
+	return fwd.ok;
+    t = DWT_CYCCNT;
+    sha256_update(&sha, p, n);
+    src.sha_cycles += DWT_CYCCNT - t;
+    fwd.ok = fwd.sink(p, n);
+    if (fwd.ok)
+	fwd.n += n;
+    return n;
+}
+
+
+/* ELF:       ,  - 0xFF */
+static int elf_read(u8 * buf, int len)
+{
+    int n = 0, k;
+    u32 off;
+
+    while (n < len && (k = elf_next(&elf, len - n, &off)) > 0) {
+	if (off == ELF_GAP) {
+	    memset(buf + n, 0xFF, k);
+	} else {
+	    if (f_tell(src.fil) != off && f_lseek(src.fil, off) != FR_OK)
+		return -1;
+	    if (file_read(buf + n, k) != k)
+		return -1;
+	}
+	n += k;
+    }
+    return n;
+}
+
+
+/**
+ *  :  0xFF  ,   .
+ *  flash    - flash_write()   
+ */
+static int sparse_read(u8 * buf, int len)
+{
+    u32 w;
+    int n = 0, k;
+
+    while (n < len) {
+	if (run.left == 0) {
+	    k = data_read(&w, sizeof(w));
+	    if (k == 0)
+		break;
+	    if (k != sizeof(w))
+		return -1;
+	    run.left = w & IMAGE_RUN_LEN;
+	    run.erased = (w & IMAGE_RUN_ERASED) != 0;
+	    continue;
+	}
+
+	k = (run.left < (u32) (len - n)) ? run.left : len - n;
+	if (run.erased)
+	    memset(buf + n, 0xFF, k);
+	else if (data_read(buf + n, k) != k)
+	    return -1;
+	run.left -= k;
+	n += k;
+    }
+    return n;
+}
+
+
+/*  len    :  ,  
+ *   HEX/SREC */
+static int data_read(void *buf, int len)
+{
+    u8 *dst = (u8 *) buf;
+    int n = 0, k;
+
+    if (!src.hs && !src.text)
+	return file_read(buf, len);
+
+    while (n < len) {
+	k = src.text ? hexrec_run(&hx, &in_p, &in_n, dst + n, len - n)
+	    : hsdec_run(&dec, &in_p, &in_n, dst + n, len - n);
+	if (k < 0)
+	    return -1;
+	n += k;
+	if (n >= len)
+	    break;
+
+	/*       */
+	if (in_n == 0) {
+	    k = file_read(in_buf, sizeof(in_buf));
+	    if (k < 0)
+		return -1;
+	    if (k == 0)
+		break;
+	    in_p = (const u8 *) in_buf;
+	    in_n = k;
+	}
+    }
+    return n;
+}
+
+
+/**
+ *     .    ,
+ *  :  CTR      
+ */
+static int file_read(void *buf, int len)
+{
+    unsigned br = 0, k = 0;
+    u32 pos = f_tell(src.fil), t, n;
+
+    /*  ,  :  disk_read()   (
+     *    CMD18),  FatFs    FAT.
+     *     f_read() */
+    n = (f_size(src.fil) - pos < (u32) len) ? f_size(src.fil) - pos : len;
+    n /= _MAX_SS;
+    if (src.lba && pos % _MAX_SS == 0 && n > 0) {
+	if (n > 255)
+	    n = 255;
+	if (disk_read(src.fil->fs->drv, buf, src.lba + pos / _MAX_SS, n) != RES_OK ||
+	    f_lseek(src.fil, pos + n * _MAX_SS) != FR_OK)
+	    return -1;
+	k = n * _MAX_SS;
+	src.direct += k;
+    }
+    if (k < (unsigned) len && f_read(src.fil, (u8 *) buf + k, len - k, &br) != FR_OK)
+	return -1;
+    src.copied += window_bytes(pos + k, br);
+    br += k;
+    src.read += br;
+    if (src.aes) {
+	t = DWT_CYCCNT;
+	aes_ctr(&aes, pos - src.data, (u8 *) buf, br);
+	src.aes_cycles += DWT_CYCCNT - t;
+    }
+    return br;
+}
+
+
+/*   n    pos f_read()    FatFs:
+ *       ,      */
+static u32 window_bytes(u32 pos, u32 n)
+{
+    u32 head = (_MAX_SS - pos % _MAX_SS) % _MAX_SS;
+
+    if (head >= n)
+	return n;
+    return head + (n - head) % _MAX_SS;
+}
+
+
+/**
+ *      ( ), 
+ * image_rewind()   .    
+ *          HEX,
+ *  ,    ELF -     
+ *  . SHA-256    
+ */
+int image_mark(void)
+{
+    src.mark = f_tell(src.fil) - in_n;
+    if (src.hs)
+	dec_mark = dec;
+    if (src.delta)
+	dlt_mark = dlt;
+    if (src.text)
+	hx_mark = hx;
+    if (src.elf)
+	elf_mark = elf;
+    run_mark = run;
+    sha_mark = sha;
+    return 1;
+}
+
+
+/*    image_mark() */
+int image_rewind(void)
+{
+    if (f_lseek(src.fil, src.mark) != FR_OK)
+	return 0;
+    in_n = 0;
+    if (src.hs)
+	dec = dec_mark;
+    if (src.delta)
+	dlt = dlt_mark;
+    if (src.text)
+	hx = hx_mark;
+    if (src.elf)
+	elf = elf_mark;
+    run = run_mark;
+    sha = sha_mark;
+    return 1;
+}
+
+
+/*   , % */
+int image_progress(void)
+{
+    return f_size(src.fil) ? f_tell(src.fil) * 100 / f_size(src.fil) : 100;
+}
+
+
+/**
+ *    pos ,   ,   .
+ *   , ELF   ( ,   
+ * ); 0 -     .     flash
+ * ( ) - SHA-256  
+ */
+int image_seek(u32 pos)
+{
+    if (!src.delta && (src.hs || src.sparse || src.text))
+	return 0;
+
+    flash_cache_flush();
+    sha256_update(&sha, (const void *) src.load, pos);
+    if (src.delta) {
+	if (!delta_skip(&dlt, pos))
+	    return 0;
+    } else if (src.elf)
+	elf_start(&elf, src.load + pos);
+    else if (f_lseek(src.fil, src.data + pos) != FR_OK)
+	return 0;
+    return image_mark();
+}
+
+
+/*       ,     */
+u32 image_file_read(void)
+{
+    return src.read;
+}
+
+
+/*       ,  FatFs */
+u32 image_file_direct(void)
+{
+    return src.direct;
+}
+
+
+/*       FatFs (f_read()   ) */
+u32 image_file_copied(void)
+{
+    return src.copied;
+}
+
+
+/*  ,     (0 -   ) */
+u32 image_base_end(void)
+{
+    return src.delta ? dlt.base_end : 0;
+}
+
+
+/*   [from, from + len)    to (. delta_copy) */
+void image_delta_copy(u32 from, u32 len, u32 to)
+{
+    delta_copy(&dlt, from, len, to);
+}
+
+
+/* SHA-256      (  ) */
+void image_digest(u8 * digest)
+{
+    sha256_t s = sha;
+
+    sha256_final(&s, digest);
+}
+
+
+/* SHA-256   (IMAGE_FLAG_SHA256)  NULL,     */
+const u8 *image_digest_expected(void)
+{
+    return has_expect ? signed_part.digest : NULL;
+}
+
+
+/**
+ *     SHA-256  key (Ed25519).
+ *      SHA-256   
+ */
+int image_signature_ok(const u8 * key)
+{
+    return has_sig && ed25519_verify(signature, (const u8 *) &signed_part, sizeof(signed_part), key);
+}
+
+
+/*     SHA-256    */
+u32 image_digest_cycles(void)
+{
+    return src.sha_cycles;
+}
+
+
+/*         */
+u32 image_decrypt_cycles(void)
+{
+    return src.aes_cycles;
+}
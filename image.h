@@ -0,0 +1,99 @@
+#ifndef _IMAGE_H
+#define _IMAGE_H
+
+#include "globdefs.h"
+#include "ff.h"
+
+
+#define IMAGE_MAGIC		0x3152444C	/* "LDR1" */
+#define IMAGE_HDR_VERSION	1
+
+/*   */
+#define IMAGE_FLAG_DATA		0x00000001	/*  : entry   */
+#define IMAGE_FLAG_HS		0x00000002	/*   heatshrink */
+#define IMAGE_FLAG_DELTA	0x00000004	/*  -     (delta.h) */
+#define IMAGE_FLAG_SPARSE	0x00000008	/*  - -, .  */
+#define IMAGE_FLAG_TEXT		0x00000010	/* :  HEX/SREC   (hexrec.h) */
+#define IMAGE_FLAG_ELF		0x00000020	/* :  ELF32 (elf.h) */
+#define IMAGE_FLAG_SHA256	0x00000040	/*   - SHA-256  */
+#define IMAGE_FLAG_SIGNED	0x00000080	/*  SHA-256 -  Ed25519 */
+#define IMAGE_FLAG_AES		0x00010000	/*   AES-CTR */
+
+/*  heatshrink (-w, -l)   8..15  */
+#define IMAGE_HS_W(flags)	(((flags) >> 8) & 0x0F)
+#define IMAGE_HS_L(flags)	(((flags) >> 12) & 0x0F)
+
+
+/**
+ *    loader.bin,   little-endian.
+ *     hdr_size ( 512 -  FatFs 
+ *   ).        .
+ * crc - CRC-32     CRC STM32 (. crc32.h),
+ * hdr_crc -       .
+ *  IMAGE_FLAG_SHA256     32  SHA-256
+ *  (   ) - hdr_size   68.
+ *  IMAGE_FLAG_SIGNED   - 64   Ed25519 
+ *   SHA-256 ( 68  ), hdr_size   132.
+ *  IMAGE_FLAG_AES    - 16    AES-CTR;
+ *    hdr_size   ,     
+ *  .  - UPDATE_AES_KEY (update.h)
+ */
+typedef struct {
+    u32 magic;			/* IMAGE_MAGIC */
+    u16 hdr_version;		/* IMAGE_HDR_VERSION */
+    u16 hdr_size;		/*      */
+    u32 size;			/*   ( ) */
+    u32 load_addr;		/*  ,   */
+    u32 entry;			/*  ,     */
+    u32 crc;			/* CRC-32  */
+    u32 flags;			/* IMAGE_FLAG_x */
+    u32 version;		/*   */
+    u32 hdr_crc;		/* CRC-32  */
+} image_header_t;
+
+
+/*   (IMAGE_FLAG_SPARSE):  " + ".
+ * :    31 ; IMAGE_RUN_ERASED -  len  0xFF,
+ *     (     ),    len  */
+#define IMAGE_RUN_ERASED	0x80000000
+#define IMAGE_RUN_LEN		0x7FFFFFFF
+
+
+/*      */
+#define IMAGE_RAW		0	/*   -    */
+#define IMAGE_VALID		1	/*     */
+#define IMAGE_BAD		-1	/*  ,   */
+#define IMAGE_TEXT		2	/* HEX/SREC:    , CRC  */
+#define IMAGE_ELF		3	/* ELF32:  -   PT_LOAD, CRC  */
+
+/*   :     FatFs  
+ *    ;    
+ *     */
+#define IMAGE_READ_SIZE		0x1000
+
+/*  image_forward():     ,  IMAGE_READ_SIZE.
+ *         FatFs -  
+ * .  0 -    */
+typedef int (*image_sink_t) (const u8 *, int);
+
+
+int image_read_header(FIL *, const char *, image_header_t *);
+int image_open(FIL *, const image_header_t *, int);
+int image_read(void *, int);
+int image_forward(u32, image_sink_t);
+int image_mark(void);
+int image_rewind(void);
+int image_progress(void);
+int image_seek(u32);
+u32 image_file_read(void);
+u32 image_file_direct(void);
+u32 image_file_copied(void);
+u32 image_base_end(void);
+void image_delta_copy(u32, u32, u32);
+void image_digest(u8 *);
+const u8 *image_digest_expected(void);
+int image_signature_ok(const u8 *);
+u32 image_digest_cycles(void);
+u32 image_decrypt_cycles(void);
+
+#endif /* image.h */
@@ -0,0 +1,158 @@
+/******************************************************************************
+ *   .     ,
+ *    ,   ,   CRC  flash
+ * (  )   
+ *****************************************************************************/
+#include <stddef.h>
+#include "journal.h"
+#include "backup.h"
+#include "crc32.h"
+#include "flash.h"
+
+
+#define jrn			((journal_t *) (BACKUP_SRAM + BACKUP_JOURNAL))
+
+
+/* CRC-32    check */
+static u32 journal_check(const journal_t * j)
+{
+    crc32_reset();
+    crc32_words((const u32 *) j, offsetof(journal_t, check) / 4);
+    return crc32_get();
+}
+
+
+/*        */
+static int journal_valid(const journal_t * j, u32 image_crc, u32 load_addr)
+{
+    return j->magic == JOURNAL_MAGIC && j->check == journal_check(j) &&
+	j->image_crc == image_crc && j->load_addr == load_addr;
+}
+
+
+/*  backup SRAM.     */
+void journal_init(void)
+{
+    backup_init();
+}
+
+
+/**
+ *      CRC image_crc   load_addr, 
+ *   flash: *done -     ( 0 - 
+ *    ), *chain -   CRC.
+ * 0 -  ,        flash
+ */
+int journal_resume(u32 image_crc, u32 load_addr, u32 * done, u32 * chain)
+{
+    journal_t j = *jrn;
+    const flash_sector_t *sec;
+    u32 addr, end, len, c = JOURNAL_CHAIN_INIT;
+
+    if (!journal_valid(&j, image_crc, load_addr))
+	return 0;
+
+    /*  ,    update.c */
+    for (addr = load_addr, end = load_addr + j.done; addr < end; addr += len) {
+	if ((sec = flash_sector(flash_sector_find(addr))) == NULL)
+	    return 0;
+	len = sec->addr + sec->size - addr;
+	if (len > end - addr)
+	    len = end - addr;
+	crc32_reset();
+	crc32_update((const void *) addr, len);
+	c = journal_chain(c, crc32_get());
+    }
+    if (c != j.crc)
+	return 0;
+
+    *done = j.done;
+    *chain = c;
+    return 1;
+}
+
+
+/**
+ *       from,  , 
+ *  : 1 -  *to, *len . 0 -  ,  
+ *    . -1 -  ,  
+ */
+int journal_copy_get(u32 from, u32 * len, u32 * to)
+{
+    journal_t j = *jrn;
+
+    if (j.magic != JOURNAL_MAGIC || j.check != journal_check(&j) ||
+	j.copy_len == 0 || j.copy_from != from)
+	return 0;
+    crc32_reset();
+    crc32_update((const void *) j.copy_to, j.copy_len);
+    if (crc32_get() != j.copy_crc)
+	return -1;
+
+    *len = j.copy_len;
+    *to = j.copy_to;
+    return 1;
+}
+
+
+/**
+ *  CRC-32    :    -
+ *     CRC,     
+ */
+u32 journal_chain(u32 chain, u32 crc)
+{
+    u32 w[2];
+
+    w[0] = chain;
+    w[1] = crc;
+    crc32_reset();
+    crc32_words(w, 2);
+    return crc32_get();
+}
+
+
+/*     done  , chain -   CRC */
+void journal_update(u32 image_crc, u32 load_addr, u32 done, u32 chain)
+{
+    journal_t j = *jrn;
+
+    /*   () ,       */
+    if (!journal_valid(&j, image_crc, load_addr)) {
+	j.copy_from = j.copy_len = j.copy_to = j.copy_crc = 0;
+	j.magic = JOURNAL_MAGIC;
+	j.image_crc = image_crc;
+	j.load_addr = load_addr;
+    }
+    j.done = done;
+    j.crc = chain;
+    j.check = journal_check(&j);
+
+    *jrn = j;
+}
+
+
+/**
+ * :   [from, from + len)    
+ *    to  flash.    (journal_update)
+ */
+void journal_copy(u32 from, u32 len, u32 to)
+{
+    journal_t j = *jrn;
+
+    j.copy_from = from;
+    j.copy_len = len;
+    j.copy_to = to;
+    crc32_reset();
+    crc32_update((const void *) to, len);
+    j.copy_crc = crc32_get();
+    j.check = journal_check(&j);
+
+    *jrn = j;
+}
+
+
+/*    -     */
+void journal_clear(void)
+{
+    jrn->magic = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include "globdefs.h"
+
+
+#define JOURNAL_MAGIC		0x314C524A	/* "JRL1" */
+
+/**
+ *    backup SRAM:     
+ *  .        (  CRC)
+ *     .
+ *          , 
+ *  ,   :  
+ *        
+ */
+typedef struct {
+    u32 magic;			/* JOURNAL_MAGIC */
+    u32 image_crc;		/* CRC-32  -       */
+    u32 load_addr;		/*    */
+    u32 done;			/*   load_addr ,    */
+    u32 crc;			/*  CRC-32  [load_addr, +done) (journal_chain) */
+    u32 copy_from;		/* :   [copy_from, +copy_len) */
+    u32 copy_len;		/*   copy_to; 0 -   */
+    u32 copy_to;
+    u32 copy_crc;		/* CRC-32  */
+    u32 check;			/* CRC-32   */
+} journal_t;
+
+#define JOURNAL_CHAIN_INIT	0
+
+
+void journal_init(void);
+int journal_resume(u32, u32, u32 *, u32 *);
+int journal_copy_get(u32, u32 *, u32 *);
+u32 journal_chain(u32, u32);
+void journal_update(u32, u32, u32, u32);
+void journal_copy(u32, u32, u32);
+void journal_clear(void);
+
+#endif /* journal.h */
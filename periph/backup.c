@@ -0,0 +1,23 @@
+#include "stm32f4xx_conf.h"
+#include "backup.h"
+
+
+/**
+ *    backup SRAM     VBAT.  
+ *   (PWR_FLAG_BRR),    VDD  -
+ *  ,    BACKUP_BRR_POLLS :   -
+ * backup SRAM    
+ */
+void backup_init(void)
+{
+    u32 n;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_BKPSRAM, ENABLE);
+    PWR_BackupRegulatorCmd(ENABLE);
+
+    for (n = 0; n < BACKUP_BRR_POLLS; n++)
+	if (PWR_GetFlagStatus(PWR_FLAG_BRR) != RESET)
+	    break;
+}
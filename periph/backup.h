@@ -0,0 +1,21 @@
+#ifndef _BACKUP_H
+#define _BACKUP_H
+
+#include "main.h"
+#include "globdefs.h"
+
+/* Backup SRAM 4K:   (  VDD   VBAT;
+ *  STM32F4 Discovery VBAT   VDD -  ).
+ *    -   */
+#define BACKUP_SRAM		((u8 *) BKPSRAM_BASE)
+#define BACKUP_SIZE		0x1000
+
+#define BACKUP_JOURNAL		0x0000	/* journal.h */
+#define BACKUP_DIRHINT		0x0040	/* FILHINT[] (ff.h, update.c):      */
+
+/*    PWR_FLAG_BRR:      */
+#define BACKUP_BRR_POLLS	100000
+
+void backup_init(void);
+
+#endif /* backup.h */
@@ -0,0 +1,340 @@
+/******************************************************************************
+ *   flash  (x32)    (x64)
+ *  FLASH_ProgramByte()   : PSIZE  PG   
+ *   ,      BSY.
+ * ,     BSY,   :  flash ,
+ *    flash_set_idle()   .
+ *        flash       -
+ *     (  ) . host: make ramcheck
+ *****************************************************************************/
+#include <string.h>
+#include "flash.h"
+#include "systick.h"
+
+
+#define CR_PSIZE_MASK		((uint32_t)0xFFFFFCFF)
+#define SECTOR_MASK		((uint32_t)0xFFFFFF07)
+#define FLASH_ERR_FLAGS		(FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | \
+				 FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+#if FLASH_PARALLELISM == 64
+#define FLASH_PSIZE		FLASH_PSIZE_DOUBLE_WORD
+#define FLASH_STEP		8
+#define FLASH_ERASED		((u64) ~0ULL)
+#else
+#define FLASH_PSIZE		FLASH_PSIZE_WORD
+#define FLASH_STEP		4
+#define FLASH_ERASED		((u32) ~0UL)
+#endif
+
+/*  flash  ,    */
+#define F_SIZE_ADDR		0x1FFF7A22
+
+
+/*  STM32F40x/41x: 4 x 16K, 1 x 64K, 7 x 128K.
+ *  const:   flash_erase_sector()   */
+static flash_sector_t sectors[] = {
+    {0x08000000, 0x4000, FLASH_Sector_0},
+    {0x08004000, 0x4000, FLASH_Sector_1},
+    {0x08008000, 0x4000, FLASH_Sector_2},
+    {0x0800C000, 0x4000, FLASH_Sector_3},
+    {0x08010000, 0x10000, FLASH_Sector_4},
+    {0x08020000, 0x20000, FLASH_Sector_5},
+    {0x08040000, 0x20000, FLASH_Sector_6},
+    {0x08060000, 0x20000, FLASH_Sector_7},
+    {0x08080000, 0x20000, FLASH_Sector_8},
+    {0x080A0000, 0x20000, FLASH_Sector_9},
+    {0x080C0000, 0x20000, FLASH_Sector_10},
+    {0x080E0000, 0x20000, FLASH_Sector_11},
+};
+
+/*   -       */
+static u64 stage[FLASH_STAGE_SIZE / sizeof(u64)];
+
+static flash_idle_t idle = NULL;
+static flash_stat_t stat;
+
+static RAMFUNC FLASH_Status flash_program_bytes(u32, const u8 *, int);
+static RAMFUNC FLASH_Status flash_program_block(u32, const u64 *, int);
+static RAMFUNC FLASH_Status flash_sr_status(void);
+static RAMFUNC int sector_count(void);
+
+
+/**
+ *  len   buf   addr.
+ *      ,  - .
+ *    , flash :  
+ * (     )   
+ */
+FLASH_Status flash_write(u32 addr, const void *buf, int len)
+{
+    const u8 *src = (const u8 *) buf;
+    FLASH_Status status;
+    int n;
+
+    /*       (    ,
+     * ) - ,      */
+    while (FLASH->SR & FLASH_FLAG_BSY);
+    FLASH->SR = FLASH_ERR_FLAGS;
+    status = FLASH_WaitForLastOperation();
+    if (status != FLASH_COMPLETE)
+	return status;
+
+    /*  -    */
+    n = (FLASH_STEP - (addr & (FLASH_STEP - 1))) & (FLASH_STEP - 1);
+    if (n > len)
+	n = len;
+    if (n) {
+	status = flash_program_bytes(addr, src, n);
+	addr += n;
+	src += n;
+	len -= n;
+    }
+
+    /*  -  :    
+     *  ,    */
+    while (status == FLASH_COMPLETE && len >= FLASH_STEP) {
+	n = len & ~(FLASH_STEP - 1);
+	if (((u32) src & (FLASH_STEP - 1)) == 0) {
+	    status = flash_program_block(addr, (const u64 *) src, n);
+	} else {
+	    if (n > (int) sizeof(stage))
+		n = (int) sizeof(stage);
+	    memcpy(stage, src, n);
+	    status = flash_program_block(addr, stage, n);
+	}
+	addr += n;
+	src += n;
+	len -= n;
+    }
+
+    /*  */
+    if (status == FLASH_COMPLETE && len > 0) {
+	status = flash_program_bytes(addr, src, len);
+    }
+
+    return status;
+}
+
+
+/**
+ *   .  BSY -   idle-.
+ *     SR
+ */
+static RAMFUNC FLASH_Status flash_wait_bsy(void)
+{
+    u32 t;
+
+    while (FLASH->SR & FLASH_FLAG_BSY) {
+	t = DWT_CYCCNT;
+	if (idle != NULL && idle()) {
+	    stat.cycles_overlap += DWT_CYCCNT - t;
+	} else {
+	    while (FLASH->SR & FLASH_FLAG_BSY);
+	    stat.cycles_wait += DWT_CYCCNT - t;
+	}
+    }
+
+    return flash_sr_status();
+}
+
+
+/*  ,  FLASH_GetStatus(),    */
+static RAMFUNC FLASH_Status flash_sr_status(void)
+{
+    u32 sr = FLASH->SR;
+
+    if (sr & FLASH_FLAG_BSY)
+	return FLASH_BUSY;
+    if (sr & FLASH_FLAG_WRPERR)
+	return FLASH_ERROR_WRP;
+    if (sr & (FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR))
+	return FLASH_ERROR_PROGRAM;
+    if (sr & FLASH_FLAG_OPERR)
+	return FLASH_ERROR_OPERATION;
+    return FLASH_COMPLETE;
+}
+
+
+/*   (x8)    */
+static RAMFUNC FLASH_Status flash_program_bytes(u32 addr, const u8 * src, int len)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+
+    FLASH->CR &= CR_PSIZE_MASK;
+    FLASH->CR |= FLASH_PSIZE_BYTE;
+    FLASH->CR |= FLASH_CR_PG;
+
+    for (; len > 0 && status == FLASH_COMPLETE; len--, addr++, src++) {
+	if (*src == 0xFF) {
+	    stat.skipped++;
+	    continue;
+	}
+	FLASH_STORE(u8, addr, *src);
+	status = flash_wait_bsy();
+    }
+
+    FLASH->CR &= (~FLASH_CR_PG);
+    return status;
+}
+
+
+/*        */
+static RAMFUNC FLASH_Status flash_program_block(u32 addr, const u64 * src, int len)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+#if FLASH_PARALLELISM == 64
+    const u64 *p = src;
+#else
+    const u32 *p = (const u32 *) src;
+#endif
+
+    FLASH->CR &= CR_PSIZE_MASK;
+    FLASH->CR |= FLASH_PSIZE;
+    FLASH->CR |= FLASH_CR_PG;
+
+    for (; len > 0 && status == FLASH_COMPLETE; len -= FLASH_STEP, addr += FLASH_STEP, p++) {
+	/*      */
+	if (*p == FLASH_ERASED) {
+	    stat.skipped++;
+	    continue;
+	}
+#if FLASH_PARALLELISM == 64
+	FLASH_STORE(u64, addr, *p);
+#else
+	FLASH_STORE(u32, addr, *p);
+#endif
+	status = flash_wait_bsy();
+    }
+
+    FLASH->CR &= (~FLASH_CR_PG);
+    return status;
+}
+
+
+/**
+ *       .
+ *     flash,    
+ */
+int flash_sector_count(void)
+{
+    return sector_count();
+}
+
+
+/* flash_sector_count()     */
+static RAMFUNC int sector_count(void)
+{
+    u32 end = FLASH_BASE + (u32) (*(__IO u16 *) F_SIZE_ADDR) * 1024;
+    int n = 0;
+
+    while (n < (int) (sizeof(sectors) / sizeof(sectors[0])) &&
+	   sectors[n].addr + sectors[n].size <= end) {
+	n++;
+    }
+    return n;
+}
+
+
+/*     */
+const flash_sector_t *flash_sector(int n)
+{
+    return (n >= 0 && n < flash_sector_count())? &sectors[n] : NULL;
+}
+
+
+/**
+ *      len   addr.
+ * addr     -     .
+ *     -1,    
+ *    flash (addr + len   -  )
+ */
+int flash_sector_range(u32 addr, u32 len, int *first, int *last)
+{
+    int n, i, num = flash_sector_count();
+
+    if (len == 0)
+	return -1;
+    for (i = 0; i < num; i++) {
+	if (sectors[i].addr == addr)
+	    break;
+    }
+
+    for (n = i; n < num; n++) {
+	if (len <= sectors[n].addr + sectors[n].size - addr) {
+	    *first = i;
+	    *last = n;
+	    return n - i + 1;
+	}
+    }
+    return -1;
+}
+
+
+/*  ,    addr,  -1 */
+int flash_sector_find(u32 addr)
+{
+    int i, num = flash_sector_count();
+
+    for (i = 0; i < num; i++) {
+	if (addr >= sectors[i].addr && addr - sectors[i].addr < sectors[i].size)
+	    return i;
+    }
+    return -1;
+}
+
+
+/**
+ *       .
+ *   ,   idle-
+ */
+RAMFUNC FLASH_Status flash_erase_sector(int n)
+{
+    FLASH_Status status;
+
+    if (n < 0 || n >= sector_count())
+	return FLASH_ERROR_OPERATION;
+
+    while (FLASH->SR & FLASH_FLAG_BSY);
+    FLASH->SR = FLASH_ERR_FLAGS;	/*  ,   flash_write() */
+    if (FLASH->SR & FLASH_ERR_FLAGS)
+	return FLASH_ERROR_PROGRAM;
+
+    FLASH->CR &= CR_PSIZE_MASK;
+    FLASH->CR |= FLASH_PSIZE;
+    FLASH->CR &= SECTOR_MASK;
+    FLASH->CR |= FLASH_CR_SER | sectors[n].id;
+    FLASH->CR |= FLASH_CR_STRT;
+
+    status = flash_wait_bsy();
+
+    FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_PG);
+    FLASH->CR &= SECTOR_MASK;
+    return status;
+}
+
+
+/*  ,  flash . NULL -   */
+void flash_set_idle(flash_idle_t f)
+{
+    idle = f;
+}
+
+
+/*     */
+const flash_stat_t *flash_get_stat(void)
+{
+    return &stat;
+}
+
+
+/**
+ *    flash:      
+ * ,   
+ */
+void flash_cache_flush(void)
+{
+    FLASH_DataCacheCmd(DISABLE);
+    FLASH_DataCacheReset();
+    FLASH_DataCacheCmd(ENABLE);
+}
@@ -0,0 +1,63 @@
+#ifndef _FLASH_H
+#define _FLASH_H
+
+#include "main.h"
+#include "globdefs.h"
+
+/*    flash:
+ * 32 -  2.7...3.6  (VoltageRange_3,  Discovery)
+ * 64 -   Vpp 8...9  (VoltageRange_4) */
+#define FLASH_PARALLELISM	32
+
+#if FLASH_PARALLELISM == 64
+#define FLASH_VOLTAGE_RANGE	VoltageRange_4
+#else
+#define FLASH_VOLTAGE_RANGE	VoltageRange_3
+#endif
+
+/*         */
+#define FLASH_STAGE_SIZE	256
+
+/* ,    flash ,     (RAMFUNC):
+ *    flash   /   */
+#define flash_busy()		((FLASH->SR & FLASH_FLAG_BSY) != 0)
+
+/*   /   flash.   PC (host/sim.h)
+ *    flash */
+#ifndef FLASH_STORE
+#define FLASH_STORE(type, addr, v)	(*(__IO type *) (addr) = (v))
+#endif
+
+
+/*   */
+typedef struct {
+    u32 addr;			/*   */
+    u32 size;			/*    */
+    u16 id;			/* FLASH_Sector_x */
+} flash_sector_t;
+
+/* ,    BSY,    */
+typedef struct {
+    u32 cycles_wait;		/*   */
+    u32 cycles_overlap;		/*  idle- */
+    u32 skipped;		/*   / 0xFF..FF -   */
+} flash_stat_t;
+
+/*    BSY.     (RAMFUNC).
+ *  0,     */
+typedef int (*flash_idle_t) (void);
+
+
+FLASH_Status flash_write(u32, const void *, int);
+
+int flash_sector_count(void);
+const flash_sector_t *flash_sector(int);
+int flash_sector_range(u32, u32, int *, int *);
+int flash_sector_find(u32);
+RAMFUNC FLASH_Status flash_erase_sector(int);
+
+void flash_set_idle(flash_idle_t);
+const flash_stat_t *flash_get_stat(void);
+void flash_cache_flush(void);
+
+#endif /* flash.h */
@@ -2,6 +2,14 @@
 #include "led.h"
 
 
+/*   : LED4   ,     */
+#define	PROGRESS_LED		LED4
+#define	PROGRESS_SLOW_MS	400	/*   0% */
+#define	PROGRESS_FAST_MS	50	/*   100% */
+
+static volatile int progress = -1;	/* -1 -   */
+static volatile int ticks = 0;
+
 
 /*  LED  */
 void led_init(void)
@@ -27,3 +35,44 @@ void led_toggle(int led)
 {
     STM_EVAL_LEDToggle(led);
 }
+
+
+/**
+ *    0...100.   -  SysTick,
+ *      . -1  
+ */
+void led_progress(int percent)
+{
+#if !LED_PROGRESS
+    percent = -1;
+#endif
+    if (percent > 100)
+	percent = 100;
+
+    if (percent < 0 && progress >= 0) {
+	progress = -1;
+	STM_EVAL_LEDOff(PROGRESS_LED);
+    } else {
+	progress = percent;
+    }
+}
+
+
+/**
+ *   SysTick   1 .
+ * SysTick_Handler(), led_tick()      flash: 
+ *   ( 1-2   128),  ,  
+ *    .   (host/) SysTick    BSY
+ */
+void led_tick(void)
+{
+    int p = progress;
+
+    if (p < 0)
+	return;
+
+    if (++ticks >= PROGRESS_SLOW_MS - (PROGRESS_SLOW_MS - PROGRESS_FAST_MS) * p / 100) {
+	ticks = 0;
+	STM_EVAL_LEDToggle(PROGRESS_LED);
+    }
+}
@@ -6,5 +6,13 @@ void led_on(int);
 void led_off(int);
 void led_toggle(int);
 
+/* 0 -    ( PC -   ) */
+#ifndef LED_PROGRESS
+#define LED_PROGRESS		1
+#endif
+
+void led_progress(int);
+void led_tick(void);
+
 
 #endif /* led.h */
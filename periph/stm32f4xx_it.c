@@ -31,6 +31,7 @@
 #include "main.h"
 #include "stm32f4xx_it.h"
 #include "systick.h"
+#include "led.h"
 
 
 /** @addtogroup STM32F4xx_StdPeriph_Examples
@@ -144,6 +145,7 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
 	TimingDelayDec();
+	led_tick();
 }
 
 /******************************************************************************/
@@ -45,7 +45,7 @@ void Delay(uint32_t nCount)
     SysTick->VAL = (uint32_t) 0x0;	//???
 
     while (TimingDelay != 0) {
-	asm("NOP");
+	__NOP();
     }
 }
 
@@ -90,3 +90,15 @@ s64 get_msex(void)
   return millisex;
 }
 
+/*     */
+void cycles_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/*     */
+u32 get_cycles(void)
+{
+    return DWT_CYCCNT;
+}
@@ -4,6 +4,14 @@
 #include "main.h"
 #include "globdefs.h"
 
+/*   DWT (  CMSIS   DWT).
+ *      ,   get_cycles() */
+#ifndef DWT_CTRL
+#define DWT_CTRL		(*(__IO uint32_t *) 0xE0001000)
+#define DWT_CYCCNT		(*(__IO uint32_t *) 0xE0001004)
+#endif
+#define DWT_CTRL_CYCCNTENA	((uint32_t) 0x00000001)
+
 void systick_init(void);
 void set_timeout(int);
 bool is_timeout(void);
@@ -13,6 +21,9 @@ void TimingDelayDec(void);
 void Delay(__IO uint32_t nCount);
 s64 get_msex(void);
 
+void cycles_init(void);
+u32 get_cycles(void);
+
 
 #define delay_ms(x)	Delay(x)
 #define delay_sec(x)	Delay(x * 1000L)
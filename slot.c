@@ -0,0 +1,148 @@
+/******************************************************************************
+ *  A/B:      .
+ *  -     :   
+ *   ,  ,    .
+ *      CRC,   
+ *****************************************************************************/
+#include <string.h>
+#include "slot.h"
+#include "flash.h"
+#include "crc32.h"
+
+
+#define RAM_START		0x20000000
+#define RAM_END			0x20020000
+#define CCM_START		0x10000000
+#define CCM_END			0x10010000
+
+
+/*  :   CRC */
+static int slot_rec_ok(const slot_rec_t * r)
+{
+    crc32_reset();
+    crc32_words(&r->magic, 3);
+    return r->magic == SLOT_MAGIC && r->slot < 2 && crc32_get() == r->crc;
+}
+
+
+/*     , NULL -   */
+static const slot_rec_t *slot_find(void)
+{
+    const flash_sector_t *sec;
+    const slot_rec_t *r, *end, *last = NULL;
+    int i;
+
+    crc32_init();
+    flash_cache_flush();
+    for (i = 0; i < 2; i++) {
+	if ((sec = flash_sector(SLOT_META_SECTOR + i)) == NULL)
+	    break;
+	r = (const slot_rec_t *) sec->addr;
+	end = (const slot_rec_t *) (sec->addr + sec->size);
+	for (; r < end && r->magic != 0xFFFFFFFF; r++) {
+	    if (slot_rec_ok(r) && (last == NULL || r->seq > last->seq))
+		last = r;
+	}
+    }
+    return last;
+}
+
+
+/*  .   - A */
+int slot_active(void)
+{
+    const slot_rec_t *r = slot_find();
+
+    return (r != NULL) ? r->slot : 0;
+}
+
+
+/*     */
+u32 slot_address(int slot)
+{
+    return slot ? SLOT_B_ADDRESS : SLOT_A_ADDRESS;
+}
+
+
+/*     addr: 0, 1  -1 -    */
+int slot_of(u32 addr)
+{
+    if (addr - SLOT_A_ADDRESS < SLOT_SIZE)
+	return 0;
+    if (addr - SLOT_B_ADDRESS < SLOT_SIZE)
+	return 1;
+    return -1;
+}
+
+
+/**
+ *         v:   ,
+ *  -  . -1 -      
+ */
+int slot_of_vectors(const u32 * v)
+{
+    if (!((v[0] > RAM_START && v[0] <= RAM_END) || (v[0] > CCM_START && v[0] <= CCM_END)))
+	return -1;
+    return slot_of(v[1]);
+}
+
+
+/*      ,     */
+int slot_valid(int slot)
+{
+    return slot_of_vectors((const u32 *) slot_address(slot)) == slot;
+}
+
+
+/**
+ *    slot:    .
+ * Flash   . 0 -  ,  
+ */
+int slot_switch(int slot)
+{
+    const flash_sector_t *sec;
+    const slot_rec_t *last = slot_find(), *r, *end;
+    slot_rec_t rec;
+    int n;
+
+    rec.magic = SLOT_MAGIC;
+    rec.slot = slot;
+    rec.seq = (last != NULL) ? last->seq + 1 : 1;
+    crc32_reset();
+    crc32_words(&rec.magic, 3);
+    rec.crc = crc32_get();
+
+    /*      */
+    n = (last != NULL) ? flash_sector_find((u32) last) : SLOT_META_SECTOR;
+    sec = flash_sector(n);
+    end = (const slot_rec_t *) (sec->addr + sec->size);
+    for (r = (last != NULL) ? last + 1 : (const slot_rec_t *) sec->addr;
+	 r < end && r->magic != 0xFFFFFFFF; r++);
+
+    /*   -   .   
+     *  ,     */
+    if (r >= end) {
+	n = SLOT_META_SECTOR + ((n == SLOT_META_SECTOR) ? 1 : 0);
+	if (flash_erase_sector(n) != FLASH_COMPLETE)
+	    return 0;
+	r = (const slot_rec_t *) flash_sector(n)->addr;
+    }
+
+    if (flash_write((u32) r, &rec, sizeof(rec)) != FLASH_COMPLETE)
+	return 0;
+    return slot_active() == slot;
+}
+
+
+/**
+ *     :  ,  
+ *   ,     - 
+ */
+u32 slot_boot(void)
+{
+    int a = slot_active();
+
+    if (!slot_valid(a) && slot_valid(!a))
+	a = !a;
+    return slot_address(a);
+}
@@ -0,0 +1,44 @@
+#ifndef _SLOT_H
+#define _SLOT_H
+
+#include "globdefs.h"
+
+
+/**
+ *    (A/B).   , 
+ *    ;  -    .
+ *      .
+ *  flash (1M):
+ *   0      
+ *   1, 2    ,   
+ *   3, 4    (, ) -   
+ *   5-7     A
+ *   8-10    B
+ *   11        
+ */
+#define SLOT_META_SECTOR	1	/*      */
+#define SLOT_DATA_ADDRESS	0x0800C000	/*  -    */
+#define SLOT_A_ADDRESS		0x08020000
+#define SLOT_B_ADDRESS		0x08080000
+#define SLOT_SIZE		0x60000
+
+#define SLOT_MAGIC		0x31544C53	/* "SLT1" */
+
+/*  :       seq */
+typedef struct {
+    u32 magic;			/* SLOT_MAGIC */
+    u32 slot;			/* 0 - A, 1 - B */
+    u32 seq;			/*     */
+    u32 crc;			/* CRC-32    */
+} slot_rec_t;
+
+
+int slot_active(void);
+u32 slot_address(int);
+int slot_of(u32);
+int slot_of_vectors(const u32 *);
+int slot_valid(int);
+int slot_switch(int);
+u32 slot_boot(void);
+
+#endif /* slot.h */
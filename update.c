@@ -0,0 +1,762 @@
+/******************************************************************************
+ *    SD :  FILE_NAME   flash
+ *      (  -  APP_ADDRESS).
+ *     FILE_NAME_HEX, FILE_NAME_SREC  FILE_NAME_ELF,
+ *   FILE_MANIFEST    
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "update.h"
+#include "systick.h"
+#include "crc32.h"
+#include "image.h"
+#include "led.h"
+#include "journal.h"
+#include "backup.h"
+#include "ed25519.h"
+#include "ff.h"
+
+
+#if UPDATE_SIGNED
+#ifndef UPDATE_PUBLIC_KEY
+#error "UPDATE_SIGNED:    UPDATE_PUBLIC_KEY"
+#endif
+static const u8 public_key[ED25519_KEY_SIZE] = UPDATE_PUBLIC_KEY;
+#endif
+
+/*    (  ) */
+typedef struct {
+    char name[13];		/*  8.3 */
+    u32 addr;			/*   , 0 -   */
+    u32 crc;			/* CRC-32  */
+    u8 has_crc;			/* CRC :     */
+    u8 installed;		/*   - flash   */
+    u8 has_sha256;		/* SHA-256   (,  UPDATE_SIGNED) */
+    u8 sha256[SHA256_SIZE];
+    s8 slot;			/* UPDATE_AB:    , -1 -    */
+    FILHINT *hint;		/*       (backup SRAM) */
+    u8 resume;			/*     -    flash */
+    u32 done, chain;		/*        CRC (journal.h) */
+    FIL fil;
+    DWORD clmt[UPDATE_CLMT_SIZE];	/*   fil */
+    image_header_t hdr;
+    int first, last;		/*   */
+} update_image_t;
+
+
+static int manifest_read(void);
+static int single_file(void);
+static int image_plan(update_image_t *);
+static void file_map(update_image_t *);
+static int image_start(update_image_t *);
+static FLASH_Status image_program(update_image_t *);
+static int sector_same(u32, u32);
+static FLASH_Status sector_program(u32, u32, u32 *);
+static int sector_verify(u32, u32, u32);
+static u32 range_crc(u32, u32);
+static void range_sha256(u32, u32, u8 *);
+static int image_check(update_image_t *);
+static int delta_plan(void);
+static int sector_save(const flash_sector_t *);
+static RAMFUNC int crc_idle(void);
+static int same_sink(const u8 *, int);
+static int program_sink(const u8 *, int);
+static int crc_sink(const u8 *, int);
+
+static update_stat_t stat;
+
+/*     ,   */
+static const char *const names[] = { FILE_NAME, FILE_NAME_HEX, FILE_NAME_SREC, FILE_NAME_ELF };
+
+/*       :     
+ *  (  )     ,
+ *    .      - , 
+ *      names[]     */
+#define DIRHINT_MANIFEST	0
+#define DIRHINT_NAMES		1
+#define DIRHINT_IMAGES		(DIRHINT_NAMES + sizeof(names) / sizeof(names[0]))
+#define dir_hints		((FILHINT *) (BACKUP_SRAM + BACKUP_DIRHINT))
+
+/*      */
+static update_image_t images[UPDATE_IMAGES_MAX];
+static int nimages;
+
+/*         -  CRC */
+static u32 buf[512 / 4];
+
+/* :    (UPDATE_SPARE_SECTOR)  
+ *  .   ,  ,  
+ *   ; 0 -    ,   -  */
+static u32 spare_free;
+
+/*  ,      CRC */
+static struct {
+    const u32 *p;
+    int n;
+} crc_job;
+
+/*   image_forward()      */
+static struct {
+    u32 addr;
+    FLASH_Status fs;
+} sink;
+
+
+/**
+ *    SD ,    FILE_MANIFEST  FILE_NAME.
+ *        -    flash,
+ *     main.c
+ */
+int update_firmware(void)
+{
+    static FATFS fatfs;		/* File system object:        */
+    FLASH_Status fs = FLASH_COMPLETE;
+    update_image_t *img;
+    u32 used = 0, mask;
+    int i, n, manifest, todo = 0;
+    s64 t0 = get_msex();
+    int res = UPDATE_NONE;
+
+
+    do {
+	/* .    -     */
+	if (f_mount(0, &fatfs) != 0) {
+	    break;
+	}
+	journal_init();		/* Backup SRAM:       */
+
+	/*         */
+	manifest = manifest_read();
+	if (manifest < 0) {
+	    res = UPDATE_ERROR;
+	    break;
+	}
+	if (!manifest && !single_file()) {
+	    break;
+	}
+
+	/*   -   :    , ,
+	 *            */
+	crc32_init();
+#if UPDATE_SPARE_SECTOR >= 0
+	used = 1UL << UPDATE_SPARE_SECTOR;
+#endif
+	for (i = 0; i < nimages; i++) {
+	    img = &images[i];
+	    if (!image_plan(img))
+		break;
+	    for (n = img->first, mask = 0; n <= img->last; n++)
+		mask |= 1UL << n;
+	    if (used & mask)
+		break;
+	    used |= mask;
+	    todo += !img->installed;
+	}
+	if (i < nimages) {
+	    res = UPDATE_ERROR;
+	    break;
+	}
+	stat.images = nimages;
+	stat.version = images[0].hdr.version;
+
+	/*     ,      CRC 
+	 * ,     - flash  .
+	 *        
+	 *   SHA-256  ;    -  
+	 * ,       */
+	for (i = 0; i < nimages; i++) {
+	    img = &images[i];
+	    if (img->installed)
+		continue;
+	    if (img->hdr.flags & IMAGE_FLAG_DELTA) {
+		/*  :    , 
+		 *   ,   CRC */
+		if (!image_start(img) || !delta_plan() || (!img->resume && !image_check(img)))
+		    break;
+	    } else if (UPDATE_SIGNED && img->slot < 0) {
+		if (!image_start(img) || !image_check(img))
+		    break;
+	    }
+	}
+	if (i < nimages) {
+	    res = UPDATE_ERROR;
+	    break;
+	}
+
+	/*   :       */
+	if (todo) {
+	    FLASH_Unlock();
+	    for (i = 0; i < nimages && fs == FLASH_COMPLETE; i++)
+		fs = image_program(&images[i]);
+	    FLASH_Lock();
+	    led_progress(-1);
+	    delay_ms(250);
+	} else {
+	    for (i = 0; i < nimages; i++)
+		stat.skipped += images[i].last - images[i].first + 1;
+	}
+
+#if UPDATE_AB
+	/*      -   .
+	 *          */
+	for (i = 0; i < nimages && fs == FLASH_COMPLETE; i++) {
+	    if (images[i].slot >= 0 && images[i].slot != slot_active()) {
+		FLASH_Unlock();
+		if (!slot_switch(images[i].slot))
+		    fs = FLASH_ERROR_PROGRAM;
+		FLASH_Lock();
+	    }
+	}
+#endif
+
+	stat.ms = get_msex() - t0;
+	stat.sd = SD_GetStat();
+#if _FS_WINS > 1
+	stat.win_hits = fatfs.whits;
+	stat.win_misses = fatfs.wmisses;
+#endif
+	stat.dir_hits = fatfs.dhits;
+	stat.flash = flash_get_stat();
+
+	/*  ,  - .     -  */
+	if (fs == FLASH_COMPLETE) {
+	    if (manifest)
+		f_unlink(FILE_MANIFEST);
+	    for (i = 0; i < nimages; i++)
+		f_unlink(images[i].name);
+	    res = UPDATE_OK;
+	} else {
+	    res = UPDATE_ERROR;
+	}
+
+    } while (0);
+
+    return res;
+}
+
+
+/*    */
+const update_stat_t *update_get_stat(void)
+{
+    return &stat;
+}
+
+
+/**
+ *   FILE_MANIFEST:    ,
+ * " [ [crc]]",  -   C (0x...),  '#' - .
+ *    , CRC -    ;
+ *      .
+ * 1 - , 0 -  , -1 - 
+ */
+static int manifest_read(void)
+{
+    update_image_t *img;
+    FIL fil;
+    unsigned br;
+    char *p, *end, *tok, *e;
+
+    nimages = 0;
+    if (f_openhint(&fil, FILE_MANIFEST, FA_READ, &dir_hints[DIRHINT_MANIFEST]) != FR_OK)
+	return 0;
+    if (f_size(&fil) >= sizeof(buf) || f_read(&fil, buf, sizeof(buf) - 1, &br) != FR_OK)
+	return -1;
+
+    p = (char *) buf;
+    p[br] = 0;
+    while (*p) {
+	end = p + strcspn(p, "\r\n");
+	if (*end)
+	    *end++ = 0;
+	p[strcspn(p, "#")] = 0;
+
+	if ((tok = strtok(p, " \t")) != NULL) {
+	    if (nimages >= UPDATE_IMAGES_MAX || strlen(tok) >= sizeof(img->name))
+		return -1;
+	    img = &images[nimages];
+	    memset(img, 0, sizeof(*img));
+	    strcpy(img->name, tok);
+	    img->hint = &dir_hints[DIRHINT_IMAGES + nimages++];
+
+	    if ((tok = strtok(NULL, " \t")) != NULL) {
+		img->addr = strtoul(tok, &e, 0);
+		if (*e)
+		    return -1;
+	    }
+	    if ((tok = strtok(NULL, " \t")) != NULL) {
+		img->crc = strtoul(tok, &e, 0);
+		img->has_crc = 1;
+		if (*e)
+		    return -1;
+	    }
+	}
+	p = end;
+    }
+
+    return (nimages > 0) ? 1 : -1;
+}
+
+
+/*   -    names[]. 0 -   */
+static int single_file(void)
+{
+    FIL fil;
+    int i;
+
+    for (i = 0; i < (int) (sizeof(names) / sizeof(names[0])); i++) {
+	if (f_openhint(&fil, names[i], FA_READ, &dir_hints[DIRHINT_NAMES + i]) == FR_OK) {
+	    memset(&images[0], 0, sizeof(images[0]));
+	    strcpy(images[0].name, names[i]);
+	    images[0].hint = &dir_hints[DIRHINT_NAMES + i];
+	    nimages = 1;
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+
+/**
+ *    ,    :  , 
+ *  ,   . 0 -   
+ */
+static int image_plan(update_image_t * img)
+{
+    image_header_t *hdr = &img->hdr;
+    int kind;
+#if UPDATE_AB
+    u32 vectors[2];		/* SP  Reset_Handler */
+    unsigned br;
+#endif
+#if UPDATE_SIGNED
+    u32 t;
+    int ok;
+#endif
+
+    if (f_openhint(&img->fil, img->name, FA_READ, img->hint) != FR_OK)
+	return 0;
+    file_map(img);
+    kind = image_read_header(&img->fil, img->name, hdr);
+    if (kind == IMAGE_BAD)
+	return 0;
+
+#if UPDATE_SIGNED
+    /*        */
+    t = DWT_CYCCNT;
+    ok = (kind == IMAGE_VALID && image_signature_ok(public_key));
+    stat.sign_cycles += DWT_CYCCNT - t;
+    if (!ok)
+	return 0;
+#endif
+    if (image_digest_expected() != NULL) {
+	memcpy(img->sha256, image_digest_expected(), SHA256_SIZE);
+	img->has_sha256 = 1;
+    }
+
+    /*   CRC  :   ,   -  */
+    if (img->addr) {
+	if (kind == IMAGE_RAW)
+	    hdr->load_addr = hdr->entry = img->addr;
+	else if (hdr->load_addr != img->addr)
+	    return 0;
+    }
+#if UPDATE_AB
+    /*     -  ,    :
+     *     .     
+     *   -   (  ) */
+    else if (kind == IMAGE_RAW) {
+	if (f_read(&img->fil, vectors, sizeof(vectors), &br) != FR_OK || br != sizeof(vectors) ||
+	    f_lseek(&img->fil, 0) != FR_OK || slot_of_vectors(vectors) < 0)
+	    return 0;
+	hdr->load_addr = hdr->entry = slot_address(slot_of_vectors(vectors));
+    }
+#endif
+    if (kind == IMAGE_VALID) {
+	if (img->has_crc && img->crc != hdr->crc)
+	    return 0;
+	img->crc = hdr->crc;
+	img->has_crc = 1;
+    }
+    hdr->crc = img->crc;
+
+    /*    ;   -   flash */
+    if (hdr->load_addr < UPDATE_MIN_ADDRESS ||
+	flash_sector_range(hdr->load_addr, hdr->size, &img->first, &img->last) < 0)
+	return 0;
+
+    /*  :  CRC ,     , SHA-256 */
+    img->installed = img->has_crc && range_crc(hdr->load_addr, hdr->size) == hdr->crc;
+    if (img->installed && img->has_sha256) {
+	range_sha256(hdr->load_addr, hdr->size, stat.sha256[img - images]);
+	img->installed = !memcmp(stat.sha256[img - images], img->sha256, SHA256_SIZE);
+    }
+
+    /*     :      flash */
+    img->resume = !img->installed && img->has_crc &&
+	journal_resume(hdr->crc, hdr->load_addr, &img->done, &img->chain);
+
+#if UPDATE_AB
+    /*   -      :  
+     *   (     - , ) */
+    img->slot = slot_of(hdr->load_addr);
+    if (img->slot >= 0 &&
+	(hdr->size == 0 || slot_of(hdr->load_addr + hdr->size - 1) != img->slot ||
+	 (img->slot == slot_active() && !img->installed)))
+	return 0;
+#else
+    img->slot = -1;
+#endif
+    return 1;
+}
+
+
+/**
+ *    -     FAT  
+ * .  f_read()     f_lseek() 
+ *   :  FAT    (_FS_TINY),  
+ * FAT     
+ */
+static void file_map(update_image_t * img)
+{
+    img->clmt[0] = UPDATE_CLMT_SIZE;
+    img->fil.cltbl = img->clmt;
+    if (f_lseek(&img->fil, CREATE_LINKMAP) == FR_OK) {
+	stat.fragments += (img->clmt[0] - 2) / 2;
+    } else {
+	img->fil.cltbl = NULL;
+	stat.unmapped++;
+    }
+}
+
+
+/**
+ *    .   :  HEX/ELF,
+ *       ,    img 
+ */
+static int image_start(update_image_t * img)
+{
+    image_header_t hdr;
+
+    return image_read_header(&img->fil, img->name, &hdr) != IMAGE_BAD &&
+	image_open(&img->fil, &img->hdr, img->resume);
+}
+
+
+/*   :       */
+static FLASH_Status image_program(update_image_t * img)
+{
+    const image_header_t *hdr = &img->hdr;
+    const flash_sector_t *sec;
+    FLASH_Status fs = FLASH_COMPLETE;
+    u32 size = hdr->size, len, pos, crc, to, chain = JOURNAL_CHAIN_INIT, restored = 0;
+    int i = img->first, k;
+
+    if (img->installed) {
+	stat.skipped += img->last - img->first + 1;
+	return FLASH_COMPLETE;
+    }
+    if (!image_start(img))
+	return FLASH_ERROR_OPERATION;
+    led_progress(0);
+
+    /*      (image_plan):   
+     *  .       - 
+     *  ;      , 
+     *     ,    */
+    spare_free = 0;
+    if (img->resume) {
+	if (image_seek(img->done)) {
+	    chain = img->chain;
+	    for (; i <= img->last && flash_sector(i)->addr < hdr->load_addr + img->done; i++)
+		stat.resumed++;
+	} else if (image_base_end()) {
+	    return FLASH_ERROR_OPERATION;
+	}
+	if (image_base_end() && i <= img->last) {
+	    k = journal_copy_get(flash_sector(i)->addr, &len, &to);
+	    if (k < 0)
+		return FLASH_ERROR_OPERATION;
+	    if (k) {
+		image_delta_copy(flash_sector(i)->addr, len, to);
+		restored = flash_sector(i)->addr;
+	    }
+	}
+    } else if (image_base_end()) {
+	/* :      */
+	journal_update(hdr->crc, hdr->load_addr, 0, chain);
+    }
+
+    for (; i <= img->last && fs == FLASH_COMPLETE; i++) {
+	sec = flash_sector(i);
+	pos = sec->addr - hdr->load_addr;
+	len = (size - pos < sec->size) ? size - pos : sec->size;
+
+#if UPDATE_SKIP_UNCHANGED
+	image_mark();
+	if (sector_same(sec->addr, len)) {
+	    stat.skipped++;
+	    if (img->has_crc) {
+		chain = journal_chain(chain, range_crc(sec->addr, len));
+		journal_update(hdr->crc, hdr->load_addr, pos + len, chain);
+	    }
+	    led_toggle(LED6);
+	    led_progress(image_progress());
+	    continue;
+	}
+	if (!image_rewind()) {
+	    fs = FLASH_ERROR_OPERATION;
+	    break;
+	}
+#endif
+	if (image_base_end() && sec->addr != restored && !sector_save(sec)) {
+	    fs = FLASH_ERROR_OPERATION;
+	    break;
+	}
+	fs = flash_erase_sector(i);
+	led_toggle(LED3);
+	if (fs == FLASH_COMPLETE) {
+	    fs = sector_program(sec->addr, len, &crc);
+	    stat.erased++;
+	}
+	if (fs == FLASH_COMPLETE && !sector_verify(sec->addr, len, crc)) {
+	    stat.verify_errors++;
+	    fs = FLASH_ERROR_PROGRAM;
+	}
+	/*   -  CRC  ,   CRC  :
+	 *    ,       */
+	if (fs == FLASH_COMPLETE && img->has_crc) {
+	    chain = journal_chain(chain, crc);
+	    journal_update(hdr->crc, hdr->load_addr, pos + len, chain);
+	}
+    }
+
+    /*    -  CRC     */
+    if (fs == FLASH_COMPLETE && img->has_crc && range_crc(hdr->load_addr, size) != hdr->crc) {
+	stat.verify_errors++;
+	fs = FLASH_ERROR_PROGRAM;
+    }
+
+    /* SHA-256 ,    , -  ,  
+     *     */
+    if (fs == FLASH_COMPLETE) {
+	image_digest(stat.sha256[img - images]);
+	if (img->has_sha256 && memcmp(stat.sha256[img - images], img->sha256, SHA256_SIZE) != 0) {
+	    stat.verify_errors++;
+	    fs = FLASH_ERROR_PROGRAM;
+	}
+    }
+    if (fs == FLASH_COMPLETE)
+	journal_clear();
+
+    stat.sha_cycles += image_digest_cycles();
+    stat.aes_cycles += image_decrypt_cycles();
+    stat.bytes += size;
+    stat.file_bytes += image_file_read();
+    stat.direct_bytes += image_file_direct();
+    stat.copy_bytes += image_file_copied();
+    return fs;
+}
+
+
+/**
+ *    len     flash.
+ *      -    
+ *  (image_rewind)
+ */
+static int sector_same(u32 addr, u32 len)
+{
+    sink.addr = addr;
+    return image_forward(len, same_sink) == (int) len;
+}
+
+
+/*  sector_same(): 0 -    flash */
+static int same_sink(const u8 * p, int n)
+{
+    if (memcmp(p, (const void *) sink.addr, n) != 0)
+	return 0;
+    sink.addr += n;
+    return 1;
+}
+
+
+/**
+ *  len    flash   addr.
+ *   CRC  :  flash  ,
+ * crc_idle()         CRC
+ */
+static FLASH_Status sector_program(u32 addr, u32 len, u32 * crc)
+{
+    crc32_reset();
+    flash_set_idle(crc_idle);
+
+    sink.addr = addr;
+    sink.fs = FLASH_COMPLETE;
+    if (image_forward(len, program_sink) != (int) len && sink.fs == FLASH_COMPLETE)
+	sink.fs = FLASH_ERROR_OPERATION;
+
+    flash_set_idle(NULL);
+    *crc = crc32_get();
+    return sink.fs;
+}
+
+
+/**
+ *  sector_program():    flash  , 
+ *    ( FatFs,  DMA) -    buf
+ */
+static int program_sink(const u8 * p, int n)
+{
+    if ((u32) p & 3) {
+	memcpy(buf, p, n);
+	p = (const u8 *) buf;
+	stat.copy_bytes += n;
+    }
+
+    crc_job.p = (const u32 *) p;
+    crc_job.n = n / 4;
+    sink.fs = flash_write(sink.addr, p, n);
+    while (crc_idle());		/*       */
+    if (n & 3)
+	crc32_update(p + (n & ~3), n & 3);
+
+    sink.addr += n;
+    led_progress(image_progress());
+    return sink.fs == FLASH_COMPLETE;
+}
+
+
+/*   CRC    . 0 -   */
+static RAMFUNC int crc_idle(void)
+{
+    int n = (crc_job.n < 8) ? crc_job.n : 8;
+
+    crc32_words(crc_job.p, n);
+    crc_job.p += n;
+    crc_job.n -= n;
+    return crc_job.n;
+}
+
+
+/**
+ *  : CRC len  flash   addr
+ *    CRC ,   
+ */
+static int sector_verify(u32 addr, u32 len, u32 crc)
+{
+    u32 t = DWT_CYCCNT;
+    int ok;
+
+    ok = (range_crc(addr, len) == crc);
+
+    stat.verify_cycles += DWT_CYCCNT - t;
+    return ok;
+}
+
+
+/* CRC-32 len  flash   addr */
+static u32 range_crc(u32 addr, u32 len)
+{
+    flash_cache_flush();
+    crc32_reset();
+    crc32_update((const void *) addr, len);
+    return crc32_get();
+}
+
+
+/* SHA-256 len  flash   addr */
+static void range_sha256(u32 addr, u32 len, u8 * digest)
+{
+    sha256_t s;
+    u32 t = DWT_CYCCNT;
+
+    flash_cache_flush();
+    sha256_init(&s);
+    sha256_update(&s, (const void *) addr, len);
+    sha256_final(&s, digest);
+    stat.sha_cycles += DWT_CYCCNT - t;
+}
+
+
+/**
+ *   ,   :   
+ *  CRC  SHA-256  .      
+ *  -  ,      
+ */
+static int image_check(update_image_t * img)
+{
+    u8 digest[SHA256_SIZE];
+    u32 size = img->hdr.size;
+
+    image_mark();
+    crc32_reset();
+    if (image_forward(size, crc_sink) != (int) size)
+	return 0;
+    if (img->has_crc && crc32_get() != img->hdr.crc)
+	return 0;
+
+    image_digest(digest);
+    if (img->has_sha256 && memcmp(digest, img->sha256, SHA256_SIZE) != 0)
+	return 0;
+    return image_rewind();
+}
+
+
+/*  image_check():  CRC */
+static int crc_sink(const u8 * p, int n)
+{
+    crc32_update(p, n);
+    return 1;
+}
+
+
+/**
+ *       :  
+ *   ,        
+ *  .      -   
+ * 
+ */
+static int delta_plan(void)
+{
+    const flash_sector_t *spare = flash_sector(UPDATE_SPARE_SECTOR);
+
+    return spare != NULL && spare->addr >= image_base_end();
+}
+
+
+/**
+ *       ,    
+ * :     ,    .
+ *  -  flash,   ,   :  
+ *       
+ */
+static int sector_save(const flash_sector_t * sec)
+{
+    const flash_sector_t *spare = flash_sector(UPDATE_SPARE_SECTOR);
+    u32 end = image_base_end(), len, to;
+
+    len = (end > sec->addr) ? end - sec->addr : 0;
+    if (len > sec->size)
+	len = sec->size;
+    if (len == 0)
+	return 1;
+    if (spare == NULL)
+	return 0;
+
+    if (len > spare_free) {
+	if (flash_erase_sector(UPDATE_SPARE_SECTOR) != FLASH_COMPLETE)
+	    return 0;
+	spare_free = spare->size;
+    }
+    to = spare->addr + spare->size - spare_free;
+    if (flash_write(to, (const void *) sec->addr, len) != FLASH_COMPLETE)
+	return 0;
+    flash_cache_flush();
+    if (memcmp((const void *) to, (const void *) sec->addr, len) != 0)
+	return 0;
+    spare_free -= (len + 3) & ~3UL;
+
+    journal_copy(sec->addr, len, to);
+    image_delta_copy(sec->addr, len, to);
+    return 1;
+}
@@ -0,0 +1,101 @@
+#ifndef _UPDATE_H
+#define _UPDATE_H
+
+#include "globdefs.h"
+#include "flash.h"
+#include "stm32_spi_sd.h"
+#include "slot.h"
+#include "sha256.h"
+
+
+#define         FILE_NAME                       "loader.bin"
+#define         FILE_NAME_HEX                   "loader.hex"	/*   FILE_NAME */
+#define         FILE_NAME_SREC                  "loader.s19"
+#define         FILE_NAME_ELF                   "loader.elf"
+#define         FILE_MANIFEST                   "loader.lst"	/*  , . update.c */
+
+/*       */
+#define		UPDATE_IMAGES_MAX		4
+#define         APP_ADDRESS			0x08004000
+
+/* 1 -    (slot.h):  , 
+ * .    SLOT_A_ADDRESS  SLOT_B_ADDRESS */
+#ifndef UPDATE_AB
+#define		UPDATE_AB			0
+#endif
+
+#if UPDATE_AB
+#define		UPDATE_MIN_ADDRESS		SLOT_DATA_ADDRESS	/*    */
+#define		UPDATE_IS_ENTRY(a)		(slot_of(a) >= 0 && slot_address(slot_of(a)) == (a))
+#else
+#define		UPDATE_MIN_ADDRESS		APP_ADDRESS
+#define		UPDATE_IS_ENTRY(a)		((a) == APP_ADDRESS)
+#endif
+
+/* 1 -     ,  Ed25519
+ * (IMAGE_FLAG_SIGNED): , HEX  ELF .   -
+ * 32 , 
+ * #define UPDATE_PUBLIC_KEY { 0xD7, 0x5A, 0x98, ... } */
+#ifndef UPDATE_SIGNED
+#define		UPDATE_SIGNED			0
+#endif
+
+/*  AES-128/192/256    (IMAGE_FLAG_AES),
+ * 16, 24  32 .   -    */
+/* #define	UPDATE_AES_KEY			{ 0x2B, 0x7E, 0x15, ... } */
+
+/* 1 -         */
+#ifndef UPDATE_SKIP_UNCHANGED
+#define		UPDATE_SKIP_UNCHANGED		1
+#endif
+
+/*     (FatFs fast seek): 2   
+ *    2.  f_read()     FAT 
+ * ;    -   FAT,   */
+#define		UPDATE_CLMT_SIZE		34
+
+/*     (,    slot.h): 
+ *      ,   
+ *   . -1 -  ,     */
+#ifndef UPDATE_SPARE_SECTOR
+#define		UPDATE_SPARE_SECTOR		11
+#endif
+
+/*   update_firmware() */
+#define		UPDATE_NONE			0	/*     - flash   */
+#define		UPDATE_OK			1	/*  ,   */
+#define		UPDATE_ERROR			-1	/* ,     */
+
+
+/*    -   */
+typedef struct {
+    int images;			/*     */
+    int erased;			/*     */
+    int skipped;		/*    */
+    int fragments;		/*      */
+    int unmapped;		/* ,      */
+    int resumed;		/*    -    */
+    int verify_errors;		/* ,    CRC */
+    u32 verify_cycles;		/*    CRC */
+    u32 sha_cycles;		/*   SHA-256    */
+    u32 sign_cycles;		/*     */
+    u32 aes_cycles;		/*    */
+    u32 bytes;			/*   */
+    u32 file_bytes;		/*    ( -   bytes) */
+    u32 direct_bytes;		/*   -      */
+    u32 copy_bytes;		/*  memcpy:   FatFs   buf */
+    u32 win_hits;		/*  FAT  ,    FatFs */
+    u32 win_misses;		/* ...     */
+    u32 dir_hits;		/* ,     backup SRAM */
+    u32 version;		/*    ()  */
+    u8 sha256[UPDATE_IMAGES_MAX][SHA256_SIZE];	/* SHA-256   */
+    u32 ms;			/*   */
+    const SD_Stat *sd;		/*   SD   flash */
+    const flash_stat_t *flash;	/*   flash      */
+} update_stat_t;
+
+
+int update_firmware(void);
+const update_stat_t *update_get_stat(void);
+
+#endif /* update.h */
@@ -0,0 +1,28 @@
+#ifndef _AES_H
+#define _AES_H
+
+#include "globdefs.h"
+
+
+/* 1 -  CRYP ( STM32F415/417;  F407  ).
+ *     stm32f4xx_cryp.c  stm32f4xx_cryp_aes.c */
+#define AES_HW			0
+
+/*  AES-CTR.   */
+typedef struct {
+    u32 rk[60];			/*   */
+    int rounds;
+    u8 iv[16];			/*   0 */
+    u32 ks[4];			/*   ks_block */
+    u32 ks_block;
+#if AES_HW
+    u8 key[32];
+    int bits;
+#endif
+} aes_t;
+
+
+int aes_init(aes_t *, const u8 *, int, const u8 *);
+void aes_ctr(aes_t *, u32, u8 *, int);
+
+#endif /* aes.h */
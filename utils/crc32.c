@@ -0,0 +1,108 @@
+/******************************************************************************
+ * CRC-32 :   CRC    (CRC32_SOFT)
+ *****************************************************************************/
+#include <string.h>
+#include "crc32.h"
+
+#ifndef CRC32_SOFT
+#include "stm32f4xx_conf.h"
+#endif
+
+
+#define CRC32_POLY	0x04C11DB7
+#define CRC32_INIT	0xFFFFFFFF
+
+
+#ifdef CRC32_SOFT
+static u32 crc_table[256];
+static u32 crc_value = CRC32_INIT;
+#endif
+
+
+/*   CRC (  ) */
+void crc32_init(void)
+{
+#ifdef CRC32_SOFT
+    u32 c;
+    int i, j;
+
+    for (i = 0; i < 256; i++) {
+	c = (u32) i << 24;
+	for (j = 0; j < 8; j++)
+	    c = (c & 0x80000000) ? (c << 1) ^ CRC32_POLY : c << 1;
+	crc_table[i] = c;
+    }
+#else
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC, ENABLE);
+#endif
+    crc32_reset();
+}
+
+
+/*    */
+void crc32_reset(void)
+{
+#ifdef CRC32_SOFT
+    crc_value = CRC32_INIT;
+#else
+    CRC->CR = CRC_CR_RESET;
+#endif
+}
+
+
+/**
+ *  n  .
+ *    -  ,  flash  
+ */
+RAMFUNC void crc32_words(const u32 * p, int n)
+{
+#ifdef CRC32_SOFT
+    u32 c = crc_value, w;
+
+    while (n-- > 0) {
+	w = *p++;
+	c = (c << 8) ^ crc_table[(c >> 24) ^ (w >> 24)];
+	c = (c << 8) ^ crc_table[(c >> 24) ^ ((w >> 16) & 0xFF)];
+	c = (c << 8) ^ crc_table[(c >> 24) ^ ((w >> 8) & 0xFF)];
+	c = (c << 8) ^ crc_table[(c >> 24) ^ (w & 0xFF)];
+    }
+    crc_value = c;
+#else
+    while (n-- > 0) {
+	CRC->DR = *p++;
+    }
+#endif
+}
+
+
+/*  len    .   0xFF */
+void crc32_update(const void *buf, int len)
+{
+    const u8 *p = (const u8 *) buf;
+    u32 w;
+
+    if (((uintptr_t) p & 3) == 0) {
+	crc32_words((const u32 *) p, len / 4);
+	p += len & ~3;
+	len &= 3;
+    }
+
+    while (len > 0) {
+	w = 0xFFFFFFFF;
+	memcpy(&w, p, (len < 4) ? len : 4);
+	crc32_words(&w, 1);
+	p += 4;
+	len -= 4;
+    }
+}
+
+
+/*   */
+u32 crc32_get(void)
+{
+#ifdef CRC32_SOFT
+    return crc_value;
+#else
+    return CRC->DR;
+#endif
+}
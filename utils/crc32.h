@@ -0,0 +1,18 @@
+#ifndef _CRC32_H
+#define _CRC32_H
+
+#include "globdefs.h"
+
+/* CRC-32    CRC STM32:
+ * Poly 0x04C11DB7, Init 0xFFFFFFFF,     XorOut,
+ *   32-    .
+ * ,   ,   0xFF.
+ *  CRC32_SOFT  ,      (  PC) */
+
+void crc32_init(void);
+void crc32_reset(void);
+RAMFUNC void crc32_words(const u32 *, int);
+void crc32_update(const void *, int);
+u32 crc32_get(void);
+
+#endif				/* crc32.h */
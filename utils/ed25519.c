@@ -0,0 +1,752 @@
+/******************************************************************************
+ *   Ed25519 (RFC 8032).  :   ,
+ *       -    .
+ *   GF(2^255 - 19) - 16    16 , 
+ * 32 x 32 -> 64  (SMLAL  Cortex-M4).
+ * [s]B - [k]A      ,  4 :
+ *  B      flash,   -
+ *   .   ,  ,  
+ *****************************************************************************/
+#include <string.h>
+#include "ed25519.h"
+
+
+/*  : x =  v[i] * 2^(16 i) */
+typedef s32 fe[16];
+
+/*    : x = X/Z, y = Y/Z, xy = T/Z */
+typedef struct {
+    fe X, Y, Z, T;
+} ge_t;
+
+/* ,    */
+typedef struct {
+    fe yplusx, yminusx, t2d, z2;	/* Y + X, Y - X, 2dT, 2Z */
+} ge_cached_t;
+
+/* SHA-512 -    k = H(R, A, M) */
+typedef struct {
+    u64 h[8];
+    u8 block[128];
+    u32 total;
+    int n;
+} sha512_t;
+
+
+/* d = -121665/121666, 2d    -1 */
+static const fe D = {
+    0x78A3, 0x1359, 0x4DCA, 0x75EB, 0xD8AB, 0x4141, 0x0A4D, 0x0070,
+    0xE898, 0x7779, 0x4079, 0x8CC7, 0xFE73, 0x2B6F, 0x6CEE, 0x5203
+};
+static const fe D2 = {
+    0xF159, 0x26B2, 0x9B94, 0xEBD6, 0xB156, 0x8283, 0x149A, 0x00E0,
+    0xD130, 0xEEF3, 0x80F2, 0x198E, 0xFCE7, 0x56DF, 0xD9DC, 0x2406
+};
+static const fe SQRTM1 = {
+    0xA0B0, 0x4A0E, 0x1B27, 0xC4EE, 0xE478, 0xAD2F, 0x1806, 0x2F43,
+    0xD7A7, 0x3DFB, 0x0099, 0x2B4D, 0xDF0B, 0x4FC1, 0x2480, 0x2B83
+};
+
+/*    L = 2^252 + 27742317777372353535851937790883648493 */
+static const u8 L[32] = {
+    0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2, 0xDE, 0xF9, 0xDE, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+};
+
+/* j * B, j = 1..15,   : y + x, y - x, 2dxy */
+static const u8 base[15][3][32] = {
+    {				/* 1 * B */
+	{0x85, 0x3B, 0x8C, 0xF5, 0xC6, 0x93, 0xBC, 0x2F, 0x19, 0x0E, 0x8C, 0xFB, 0xC6, 0x2D, 0x93, 0xCF,
+	 0xC2, 0x42, 0x3D, 0x64, 0x98, 0x48, 0x0B, 0x27, 0x65, 0xBA, 0xD4, 0x33, 0x3A, 0x9D, 0xCF, 0x07},
+	{0x3E, 0x91, 0x40, 0xD7, 0x05, 0x39, 0x10, 0x9D, 0xB3, 0xBE, 0x40, 0xD1, 0x05, 0x9F, 0x39, 0xFD,
+	 0x09, 0x8A, 0x8F, 0x68, 0x34, 0x84, 0xC1, 0xA5, 0x67, 0x12, 0xF8, 0x98, 0x92, 0x2F, 0xFD, 0x44},
+	{0x68, 0xAA, 0x7A, 0x87, 0x05, 0x12, 0xC9, 0xAB, 0x9E, 0xC4, 0xAA, 0xCC, 0x23, 0xE8, 0xD9, 0x26,
+	 0x8C, 0x59, 0x43, 0xDD, 0xCB, 0x7D, 0x1B, 0x5A, 0xA8, 0x65, 0x0C, 0x9F, 0x68, 0x7B, 0x11, 0x6F}
+    },
+    {				/* 2 * B */
+	{0xD7, 0x71, 0x3C, 0x93, 0xFC, 0xE7, 0x24, 0x92, 0xB5, 0xF5, 0x0F, 0x7A, 0x96, 0x9D, 0x46, 0x9F,
+	 0x02, 0x07, 0xD6, 0xE1, 0x65, 0x9A, 0xA6, 0x5A, 0x2E, 0x2E, 0x7D, 0xA8, 0x3F, 0x06, 0x0C, 0x59},
+	{0xA8, 0xD5, 0xB4, 0x42, 0x60, 0xA5, 0x99, 0x8A, 0xF6, 0xAC, 0x60, 0x4E, 0x0C, 0x81, 0x2B, 0x8F,
+	 0xAA, 0x37, 0x6E, 0xB1, 0x6B, 0x23, 0x9E, 0xE0, 0x55, 0x25, 0xC9, 0x69, 0xA6, 0x95, 0xB5, 0x6B},
+	{0x5F, 0x7A, 0x9B, 0xA5, 0xB3, 0xA8, 0xFA, 0x43, 0x78, 0xCF, 0x9A, 0x5D, 0xDD, 0x6B, 0xC1, 0x36,
+	 0x31, 0x6A, 0x3D, 0x0B, 0x84, 0xA0, 0x0F, 0x50, 0x73, 0x0B, 0xA5, 0x3E, 0xB1, 0xF5, 0x1A, 0x70}
+    },
+    {				/* 3 * B */
+	{0x30, 0x97, 0xEE, 0x4C, 0xA8, 0xB0, 0x25, 0xAF, 0x8A, 0x4B, 0x86, 0xE8, 0x30, 0x84, 0x5A, 0x02,
+	 0x32, 0x67, 0x01, 0x9F, 0x02, 0x50, 0x1B, 0xC1, 0xF4, 0xF8, 0x80, 0x9A, 0x1B, 0x4E, 0x16, 0x7A},
+	{0x65, 0xD2, 0xFC, 0xA4, 0xE8, 0x1F, 0x61, 0x56, 0x7D, 0xBA, 0xC1, 0xE5, 0xFD, 0x53, 0xD3, 0x3B,
+	 0xBD, 0xD6, 0x4B, 0x21, 0x1A, 0xF3, 0x31, 0x81, 0x62, 0xDA, 0x5B, 0x55, 0x87, 0x15, 0xB9, 0x2A},
+	{0x89, 0xD8, 0xD0, 0x0D, 0x3F, 0x93, 0xAE, 0x14, 0x62, 0xDA, 0x35, 0x1C, 0x22, 0x23, 0x94, 0x58,
+	 0x4C, 0xDB, 0xF2, 0x8C, 0x45, 0xE5, 0x70, 0xD1, 0xC6, 0xB4, 0xB9, 0x12, 0xAF, 0x26, 0x28, 0x5A}
+    },
+    {				/* 4 * B */
+	{0x9F, 0x09, 0xFC, 0x8E, 0xB9, 0x51, 0x73, 0x28, 0x38, 0x25, 0xFD, 0x7D, 0xF4, 0xC6, 0x65, 0x67,
+	 0x65, 0x92, 0x0A, 0xFB, 0x3D, 0x8D, 0x34, 0xCA, 0x27, 0x87, 0xE5, 0x21, 0x03, 0x91, 0x0E, 0x68},
+	{0xBF, 0x18, 0x68, 0x05, 0x0A, 0x05, 0xFE, 0x95, 0xA9, 0xFA, 0x60, 0x56, 0x71, 0x89, 0x7E, 0x32,
+	 0x73, 0x50, 0xA0, 0x06, 0xCD, 0xE3, 0xE8, 0xC3, 0x9A, 0xA4, 0x45, 0x74, 0x4C, 0x3F, 0x93, 0x27},
+	{0x09, 0xFF, 0x76, 0xC4, 0xE9, 0xFB, 0x13, 0x5A, 0x72, 0xC1, 0x5C, 0x7B, 0x45, 0x39, 0x9E, 0x6E,
+	 0x94, 0x44, 0x2B, 0x10, 0xF9, 0xDC, 0xDB, 0x5D, 0x2B, 0x3E, 0x55, 0x63, 0xBF, 0x0C, 0x9D, 0x7F}
+    },
+    {				/* 5 * B */
+	{0x33, 0xBB, 0xA5, 0x08, 0x44, 0xBC, 0x12, 0xA2, 0x02, 0xED, 0x5E, 0xC7, 0xC3, 0x48, 0x50, 0x8D,
+	 0x44, 0xEC, 0xBF, 0x5A, 0x0C, 0xEB, 0x1B, 0xDD, 0xEB, 0x06, 0xE2, 0x46, 0xF1, 0xCC, 0x45, 0x29},
+	{0xBA, 0xD6, 0x47, 0xA4, 0xC3, 0x82, 0x91, 0x7F, 0xB7, 0x29, 0x27, 0x4B, 0xD1, 0x14, 0x00, 0xD5,
+	 0x87, 0xA0, 0x64, 0xB8, 0x1C, 0xF1, 0x3C, 0xE3, 0xF3, 0x55, 0x1B, 0xEB, 0x73, 0x7E, 0x4A, 0x15},
+	{0x85, 0x82, 0x2A, 0x81, 0xF1, 0xDB, 0xBB, 0xBC, 0xFC, 0xD1, 0xBD, 0xD0, 0x07, 0x08, 0x0E, 0x27,
+	 0x2D, 0xA7, 0xBD, 0x1B, 0x0B, 0x67, 0x1B, 0xB4, 0x9A, 0xB6, 0x3B, 0x6B, 0x69, 0xBE, 0xAA, 0x43}
+    },
+    {				/* 6 * B */
+	{0x31, 0x71, 0x15, 0x77, 0xEB, 0xEE, 0x0C, 0x3A, 0x88, 0xAF, 0xC8, 0x00, 0x89, 0x15, 0x27, 0x9B,
+	 0x36, 0xA7, 0x59, 0xDA, 0x68, 0xB6, 0x65, 0x80, 0xBD, 0x38, 0xCC, 0xA2, 0xB6, 0x7B, 0xE5, 0x51},
+	{0xA4, 0x8C, 0x7D, 0x7B, 0xB6, 0x06, 0x98, 0x49, 0x39, 0x27, 0xD2, 0x27, 0x84, 0xE2, 0x5B, 0x57,
+	 0xB9, 0x53, 0x45, 0x20, 0xE7, 0x5C, 0x08, 0xBB, 0x84, 0x78, 0x41, 0xAE, 0x41, 0x4C, 0xB6, 0x38},
+	{0x71, 0x4B, 0xEA, 0x02, 0x67, 0x32, 0xAC, 0x85, 0x01, 0xBB, 0xA1, 0x41, 0x03, 0xE0, 0x70, 0xBE,
+	 0x44, 0xC1, 0x3B, 0x08, 0x4B, 0xA2, 0xE4, 0x53, 0xE3, 0x61, 0x0D, 0x9F, 0x1A, 0xE9, 0xB8, 0x10}
+    },
+    {				/* 7 * B */
+	{0xBF, 0xA3, 0x4E, 0x94, 0xD0, 0x5C, 0x1A, 0x6B, 0xD2, 0xC0, 0x9D, 0xB3, 0x3A, 0x35, 0x70, 0x74,
+	 0x49, 0x2E, 0x54, 0x28, 0x82, 0x52, 0xB2, 0x71, 0x7E, 0x92, 0x3C, 0x28, 0x69, 0xEA, 0x1B, 0x46},
+	{0xB1, 0x21, 0x32, 0xAA, 0x9A, 0x2C, 0x6F, 0xBA, 0xA7, 0x23, 0xBA, 0x3B, 0x53, 0x21, 0xA0, 0x6C,
+	 0x3A, 0x2C, 0x19, 0x92, 0x4F, 0x76, 0xEA, 0x9D, 0xE0, 0x17, 0x53, 0x2E, 0x5D, 0xDD, 0x6E, 0x1D},
+	{0xA2, 0xB3, 0xB8, 0x01, 0xC8, 0x6D, 0x83, 0xF1, 0x9A, 0xA4, 0x3E, 0x05, 0x47, 0x5F, 0x03, 0xB3,
+	 0xF3, 0xAD, 0x77, 0x58, 0xBA, 0x41, 0x9C, 0x52, 0xA7, 0x90, 0x0F, 0x6A, 0x1C, 0xBB, 0x9F, 0x7A}
+    },
+    {				/* 8 * B */
+	{0x8F, 0x3E, 0xDD, 0x04, 0x66, 0x59, 0xB7, 0x59, 0x2C, 0x70, 0x88, 0xE2, 0x77, 0x03, 0xB3, 0x6C,
+	 0x23, 0xC3, 0xD9, 0x5E, 0x66, 0x9C, 0x33, 0xB1, 0x2F, 0xE5, 0xBC, 0x61, 0x60, 0xE7, 0x15, 0x09},
+	{0xD9, 0x34, 0x92, 0xF3, 0xED, 0x5D, 0xA7, 0xE2, 0xF9, 0x58, 0xB5, 0xE1, 0x80, 0x76, 0x3D, 0x96,
+	 0xFB, 0x23, 0x3C, 0x6E, 0xAC, 0x41, 0x27, 0x2C, 0xC3, 0x01, 0x0E, 0x32, 0xA1, 0x24, 0x90, 0x3A},
+	{0x1A, 0x91, 0xA2, 0xC9, 0xD9, 0xF5, 0xC1, 0xE7, 0xD7, 0xA7, 0xCC, 0x8B, 0x78, 0x71, 0xA3, 0xB8,
+	 0x32, 0x2A, 0xB6, 0x0E, 0x19, 0x12, 0x64, 0x63, 0x95, 0x4E, 0xCC, 0x2E, 0x5C, 0x7C, 0x90, 0x26}
+    },
+    {				/* 9 * B */
+	{0x2F, 0x63, 0xA8, 0xA6, 0x8A, 0x67, 0x2E, 0x9B, 0xC5, 0x46, 0xBC, 0x51, 0x6F, 0x9E, 0x50, 0xA6,
+	 0xB5, 0xF5, 0x86, 0xC6, 0xC9, 0x33, 0xB2, 0xCE, 0x59, 0x7F, 0xDD, 0x8A, 0x33, 0xED, 0xB9, 0x34},
+	{0x64, 0x80, 0x9D, 0x03, 0x7E, 0x21, 0x6E, 0xF3, 0x9B, 0x41, 0x20, 0xF5, 0xB6, 0x81, 0xA0, 0x98,
+	 0x44, 0xB0, 0x5E, 0xE7, 0x08, 0xC6, 0xCB, 0x96, 0x8F, 0x9C, 0xDC, 0xFA, 0x51, 0x5A, 0xC0, 0x49},
+	{0x1B, 0xAF, 0x45, 0x90, 0xBF, 0xE8, 0xB4, 0x06, 0x2F, 0xD2, 0x19, 0xA7, 0xE8, 0x83, 0xFF, 0xE2,
+	 0x16, 0xCF, 0xD4, 0x93, 0x29, 0xFC, 0xF6, 0xAA, 0x06, 0x8B, 0x00, 0x1B, 0x02, 0x72, 0xC1, 0x73}
+    },
+    {				/* 10 * B */
+	{0x8E, 0x74, 0x60, 0xB3, 0xD2, 0x93, 0x1D, 0xFF, 0x57, 0xE0, 0x17, 0x16, 0xD4, 0x34, 0xF5, 0x45,
+	 0x46, 0x46, 0x55, 0x9B, 0x63, 0x03, 0x55, 0x0D, 0xED, 0x91, 0xE5, 0xAA, 0x28, 0x76, 0xAC, 0x43},
+	{0xDD, 0x81, 0x70, 0x22, 0x8E, 0x55, 0xF3, 0x75, 0x2F, 0xF0, 0xA9, 0x65, 0x36, 0x18, 0xF8, 0x04,
+	 0x58, 0x39, 0xDC, 0xF5, 0x45, 0x97, 0x73, 0x84, 0x02, 0xB7, 0x50, 0x49, 0x2C, 0x83, 0x53, 0x03},
+	{0xD8, 0xF8, 0xD0, 0x03, 0xE4, 0x2A, 0x3D, 0xD0, 0x40, 0x63, 0xF0, 0xD3, 0xCB, 0x1C, 0x0C, 0x1D,
+	 0x09, 0xB5, 0x31, 0x67, 0x0F, 0x9F, 0x16, 0xFF, 0xE7, 0x4C, 0xBF, 0x70, 0xF4, 0x2A, 0xC6, 0x0E}
+    },
+    {				/* 11 * B */
+	{0xDE, 0x2A, 0x80, 0x8A, 0x84, 0x00, 0xBF, 0x2F, 0x27, 0x2E, 0x30, 0x02, 0xCF, 0xFE, 0xD9, 0xE5,
+	 0x06, 0x34, 0x70, 0x17, 0x71, 0x84, 0x3E, 0x11, 0xAF, 0x8F, 0x6D, 0x54, 0xE2, 0xAA, 0x75, 0x42},
+	{0x48, 0x43, 0x86, 0x49, 0x02, 0x5B, 0x5F, 0x31, 0x81, 0x83, 0x08, 0x77, 0x69, 0xB3, 0xD6, 0x3E,
+	 0x95, 0xEB, 0x8D, 0x6A, 0x55, 0x75, 0xA0, 0xA3, 0x7F, 0xC7, 0xD5, 0x29, 0x80, 0x59, 0xAB, 0x18},
+	{0xE9, 0x89, 0x60, 0xFD, 0xC5, 0x2C, 0x2B, 0xD8, 0xA4, 0xE4, 0x82, 0x32, 0xA1, 0xB4, 0x1E, 0x03,
+	 0x22, 0x86, 0x1A, 0xB5, 0x99, 0x11, 0x31, 0x44, 0x48, 0xF9, 0x3D, 0xB5, 0x22, 0x55, 0xC6, 0x3D}
+    },
+    {				/* 12 * B */
+	{0x39, 0x75, 0x1E, 0xA7, 0x42, 0x80, 0x35, 0xE2, 0xA9, 0xD1, 0x34, 0xD8, 0xD7, 0x3D, 0xDE, 0x88,
+	 0x93, 0x6F, 0x1A, 0x70, 0x2E, 0xDD, 0xEC, 0x45, 0x58, 0xDD, 0x3C, 0x8D, 0xDE, 0xAF, 0x8A, 0x07},
+	{0xB9, 0x54, 0x3D, 0xB5, 0x75, 0x83, 0x6F, 0x85, 0x24, 0x5B, 0xB2, 0xCC, 0x90, 0xBF, 0xB2, 0x23,
+	 0xDD, 0xDB, 0xD5, 0x56, 0x6E, 0xFB, 0x4D, 0x88, 0xED, 0x22, 0x60, 0x8A, 0xE2, 0xEC, 0x56, 0x79},
+	{0x53, 0x45, 0x94, 0x7F, 0xD8, 0x94, 0xA5, 0xEE, 0x0B, 0x18, 0x4E, 0xA2, 0x23, 0xDA, 0x6C, 0xF6,
+	 0x61, 0x64, 0x97, 0xF4, 0x9A, 0x58, 0xCB, 0xFF, 0xC6, 0xD0, 0x83, 0x1C, 0x15, 0xA5, 0xC6, 0x37}
+    },
+    {				/* 13 * B */
+	{0x6D, 0x7F, 0x00, 0xA2, 0x22, 0xC2, 0x70, 0xBF, 0xDB, 0xDE, 0xBC, 0xB5, 0x9A, 0xB3, 0x84, 0xBF,
+	 0x07, 0xBA, 0x07, 0xFB, 0x12, 0x0E, 0x7A, 0x53, 0x41, 0xF2, 0x46, 0xC3, 0xEE, 0xD7, 0x4F, 0x23},
+	{0x93, 0xBF, 0x7F, 0x32, 0x3B, 0x01, 0x6F, 0x50, 0x6B, 0x6F, 0x77, 0x9B, 0xC9, 0xEB, 0xFC, 0xAE,
+	 0x68, 0x59, 0xAD, 0xAA, 0x32, 0xB2, 0x12, 0x9D, 0xA7, 0x24, 0x60, 0x17, 0x2D, 0x88, 0x67, 0x02},
+	{0x78, 0xA3, 0x2E, 0x73, 0x19, 0xA1, 0x60, 0x53, 0x71, 0xD4, 0x8D, 0xDF, 0xB1, 0xE6, 0x37, 0x24,
+	 0x33, 0xE5, 0xA7, 0x91, 0xF8, 0x37, 0xEF, 0xA2, 0x63, 0x78, 0x09, 0xAA, 0xFD, 0xA6, 0x7B, 0x49}
+    },
+    {				/* 14 * B */
+	{0xF2, 0x3D, 0x21, 0x3F, 0xEC, 0x70, 0xF8, 0x26, 0x87, 0xA9, 0xEF, 0x57, 0xC0, 0x7F, 0x27, 0x80,
+	 0xD5, 0xBD, 0x81, 0x28, 0x04, 0x4C, 0x47, 0x1A, 0x30, 0x16, 0x4D, 0x46, 0xB2, 0x60, 0xAF, 0x6E},
+	{0x80, 0x12, 0x17, 0xD4, 0x44, 0x8A, 0xDB, 0xDF, 0x31, 0xA3, 0x7C, 0xDB, 0x0F, 0xB2, 0x69, 0xCE,
+	 0xA9, 0x47, 0xEC, 0x6E, 0xF1, 0x56, 0x2E, 0x11, 0xD2, 0x80, 0x3C, 0x5B, 0x2C, 0xEA, 0xF0, 0x2D},
+	{0x82, 0x1B, 0x1E, 0x7A, 0x87, 0xC5, 0xA1, 0x96, 0x54, 0xBF, 0xA9, 0xA2, 0xED, 0x97, 0x23, 0xF0,
+	 0xAA, 0x1B, 0xCB, 0x3E, 0x70, 0xDF, 0x1F, 0x9C, 0x93, 0x9C, 0xBA, 0xD8, 0x3C, 0x7E, 0xBF, 0x24}
+    },
+    {				/* 15 * B */
+	{0xA0, 0xEA, 0xCF, 0x13, 0x03, 0xCC, 0xCE, 0x24, 0x6D, 0x24, 0x9C, 0x18, 0x8D, 0xC2, 0x48, 0x86,
+	 0xD0, 0xD4, 0xF2, 0xC1, 0xFA, 0xBD, 0xBD, 0x2D, 0x2B, 0xE7, 0x2D, 0xF1, 0x17, 0x29, 0xE2, 0x61},
+	{0x0B, 0xCF, 0x8C, 0x46, 0x86, 0xCD, 0x0B, 0x04, 0xD6, 0x10, 0x99, 0x2A, 0xA4, 0x9B, 0x82, 0xD3,
+	 0x92, 0x51, 0xB2, 0x07, 0x08, 0x30, 0x08, 0x75, 0xBF, 0x5E, 0xD0, 0x18, 0x42, 0xCD, 0xB5, 0x43},
+	{0x16, 0xB5, 0xD0, 0x9B, 0x2F, 0x76, 0x9A, 0x5D, 0xEE, 0xDE, 0x3F, 0x37, 0x4E, 0xAF, 0x38, 0xEB,
+	 0x70, 0x42, 0xD6, 0x93, 0x7D, 0x5A, 0x2E, 0x03, 0x42, 0xD8, 0xE4, 0x0A, 0x21, 0x61, 0x1D, 0x51}
+    }
+};
+
+static const u64 K512[80] = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL,
+    0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+    0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL,
+    0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+    0xD807AA98A3030242ULL, 0x12835B0145706FBEULL,
+    0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL,
+    0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+    0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL,
+    0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+    0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL,
+    0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL,
+    0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+    0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL,
+    0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+    0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL,
+    0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL,
+    0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+    0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL,
+    0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+    0xD192E819D6EF5218ULL, 0xD69906245565A910ULL,
+    0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL,
+    0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+    0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL,
+    0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+    0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL,
+    0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL,
+    0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+    0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL,
+    0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+    0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL,
+    0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL,
+    0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+    0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL,
+    0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL,
+};
+
+
+/*   - :    2 */
+static ge_cached_t table[15];	/* j * (-A), j = 1..15 */
+static ge_cached_t bq;		/*  base[],   fe */
+static ge_t acc;
+static sha512_t sha;
+static s64 wide[64];
+
+
+static void fe_add(fe o, const fe a, const fe b)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+	o[i] = a[i] + b[i];
+}
+
+
+static void fe_sub(fe o, const fe a, const fe b)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+	o[i] = a[i] - b[i];
+}
+
+
+static void fe_neg(fe o)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+	o[i] = -o[i];
+}
+
+
+/* :   0..0xFFFF,    -   2^256 = 38 */
+static void fe_carry(s64 * t)
+{
+    s64 c;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+	c = t[i] >> 16;
+	t[i] &= 0xFFFF;
+	if (i < 15)
+	    t[i + 1] += c;
+	else
+	    t[0] += 38 * c;
+    }
+}
+
+
+/*   31  -    */
+static void fe_reduce(fe o, s64 * t)
+{
+    int i;
+
+    for (i = 0; i < 15; i++)
+	t[i] += 38 * t[i + 16];
+    fe_carry(t);
+    fe_carry(t);
+    for (i = 0; i < 16; i++)
+	o[i] = (s32) t[i];
+}
+
+
+static void fe_mul(fe o, const fe a, const fe b)
+{
+    s64 t[31];
+    int i, j;
+
+    memset(t, 0, sizeof(t));
+    for (i = 0; i < 16; i++) {
+	for (j = 0; j < 16; j++)
+	    t[i + j] += (s64) a[i] * b[j];
+    }
+    fe_reduce(o, t);
+}
+
+
+/* :      */
+static void fe_sq(fe o, const fe a)
+{
+    s64 t[31];
+    s32 a2;
+    int i, j;
+
+    memset(t, 0, sizeof(t));
+    for (i = 0; i < 16; i++) {
+	t[2 * i] += (s64) a[i] * a[i];
+	a2 = 2 * a[i];
+	for (j = i + 1; j < 16; j++)
+	    t[i + j] += (s64) a2 * a[j];
+    }
+    fe_reduce(o, t);
+}
+
+
+/* a^(2^252 - 3) -    */
+static void fe_pow2523(fe o, const fe a)
+{
+    fe c;
+    int i;
+
+    memcpy(c, a, sizeof(fe));
+    for (i = 250; i >= 0; i--) {
+	fe_sq(c, c);
+	if (i != 1)
+	    fe_mul(c, c, a);
+    }
+    memcpy(o, c, sizeof(fe));
+}
+
+
+/* 1/a = a^(p - 2) */
+static void fe_inv(fe o, const fe a)
+{
+    fe c;
+    int i;
+
+    memcpy(c, a, sizeof(fe));
+    for (i = 253; i >= 0; i--) {
+	fe_sq(c, c);
+	if (i != 2 && i != 4)
+	    fe_mul(c, c, a);
+    }
+    memcpy(o, c, sizeof(fe));
+}
+
+
+/* 32  little-endian;     */
+static void fe_unpack(fe o, const u8 * s)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+	o[i] = s[2 * i] | (s[2 * i + 1] << 8);
+    o[15] &= 0x7FFF;
+}
+
+
+/*   ( p)  32  */
+static void fe_pack(u8 * s, const fe a)
+{
+    s64 t[16];
+    s32 m[16];
+    int i, j, b;
+
+    for (i = 0; i < 16; i++)
+	t[i] = a[i];
+    fe_carry(t);
+    fe_carry(t);
+    fe_carry(t);
+
+    /*    2^256 < 3p:   p,   */
+    for (j = 0; j < 2; j++) {
+	m[0] = (s32) t[0] - 0xFFED;
+	for (i = 1; i < 15; i++) {
+	    m[i] = (s32) t[i] - 0xFFFF - ((m[i - 1] >> 16) & 1);
+	    m[i - 1] &= 0xFFFF;
+	}
+	m[15] = (s32) t[15] - 0x7FFF - ((m[14] >> 16) & 1);
+	b = (m[15] >> 16) & 1;
+	m[14] &= 0xFFFF;
+	if (!b) {
+	    for (i = 0; i < 16; i++)
+		t[i] = m[i];
+	}
+    }
+
+    for (i = 0; i < 16; i++) {
+	s[2 * i] = (u8) t[i];
+	s[2 * i + 1] = (u8) (t[i] >> 8);
+    }
+}
+
+
+static int fe_equal(const fe a, const fe b)
+{
+    u8 x[32], y[32];
+
+    fe_pack(x, a);
+    fe_pack(y, b);
+    return memcmp(x, y, 32) == 0;
+}
+
+
+static int fe_parity(const fe a)
+{
+    u8 s[32];
+
+    fe_pack(s, a);
+    return s[0] & 1;
+}
+
+
+/* r = p + q. r    p */
+static void ge_add(ge_t * r, const ge_t * p, const ge_cached_t * q)
+{
+    fe a, b, c, d, e;
+
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, q->yminusx);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, q->yplusx);
+    fe_mul(c, p->T, q->t2d);
+    fe_mul(d, p->Z, q->z2);
+
+    fe_sub(e, b, a);		/* E */
+    fe_add(b, b, a);		/* H */
+    fe_sub(a, d, c);		/* F */
+    fe_add(d, d, c);		/* G */
+
+    fe_mul(r->X, e, a);
+    fe_mul(r->Y, d, b);
+    fe_mul(r->T, e, b);
+    fe_mul(r->Z, a, d);
+}
+
+
+/* r = 2p. r    p */
+static void ge_dbl(ge_t * r, const ge_t * p)
+{
+    fe a, b, c, e, g;
+
+    fe_sq(a, p->X);
+    fe_sq(b, p->Y);
+    fe_sq(c, p->Z);
+    fe_add(c, c, c);
+    fe_add(e, p->X, p->Y);
+    fe_sq(e, e);
+    fe_sub(e, e, a);
+    fe_sub(e, e, b);		/* E = 2XY */
+
+    fe_sub(g, b, a);		/* G = B - A */
+    fe_add(a, a, b);
+    fe_neg(a);			/* H = -A - B */
+    fe_sub(c, g, c);		/* F = G - C */
+
+    fe_mul(r->X, e, c);
+    fe_mul(r->Y, g, a);
+    fe_mul(r->T, e, a);
+    fe_mul(r->Z, c, g);
+}
+
+
+static void ge_cache(ge_cached_t * c, const ge_t * p)
+{
+    fe_add(c->yplusx, p->Y, p->X);
+    fe_sub(c->yminusx, p->Y, p->X);
+    fe_mul(c->t2d, p->T, D2);
+    fe_add(c->z2, p->Z, p->Z);
+}
+
+
+/**
+ * -A  32   (RFC 8032, 5.1.3). x = u v^3 (u v^7)^((p-5)/8),
+ * u = y^2 - 1, v = dy^2 + 1. 0 -       
+ */
+static int ge_unpack_neg(ge_t * r, const u8 * s)
+{
+    fe u, v, v3, t;
+    u8 y[32];
+
+    fe_unpack(r->Y, s);
+    fe_pack(y, r->Y);
+    if (memcmp(y, s, 31) != 0 || y[31] != (s[31] & 0x7F))
+	return 0;
+
+    memset(r->Z, 0, sizeof(fe));
+    r->Z[0] = 1;
+    fe_sq(u, r->Y);
+    fe_mul(v, u, D);
+    fe_sub(u, u, r->Z);
+    fe_add(v, v, r->Z);
+
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v);
+    fe_sq(t, v3);
+    fe_mul(t, t, v);
+    fe_mul(t, t, u);
+    fe_pow2523(t, t);
+    fe_mul(t, t, v3);
+    fe_mul(r->X, t, u);
+
+    /* vx^2   u  -u ( x     -1) */
+    fe_sq(t, r->X);
+    fe_mul(t, t, v);
+    if (!fe_equal(t, u)) {
+	fe_neg(t);
+	if (!fe_equal(t, u))
+	    return 0;
+	fe_mul(r->X, r->X, SQRTM1);
+    }
+
+    /*  x -  ; x = 0   1  .   -x */
+    fe_pack(y, r->X);
+    if ((s[31] >> 7) && y[0] == 0 && memcmp(y, y + 1, 31) == 0)
+	return 0;
+    if ((y[0] & 1) == (s[31] >> 7))
+	fe_neg(r->X);
+
+    fe_mul(r->T, r->X, r->Y);
+    return 1;
+}
+
+
+/*   32 : y   x */
+static void ge_pack(u8 * s, const ge_t * p)
+{
+    fe zi, x, y;
+
+    fe_inv(zi, p->Z);
+    fe_mul(x, p->X, zi);
+    fe_mul(y, p->Y, zi);
+    fe_pack(s, y);
+    s[31] ^= fe_parity(x) << 7;
+}
+
+
+/* base[j] -  bq (Z = 1, 2Z = 2) */
+static void base_load(int j)
+{
+    fe_unpack(bq.yplusx, base[j][0]);
+    fe_unpack(bq.yminusx, base[j][1]);
+    fe_unpack(bq.t2d, base[j][2]);
+    memset(bq.z2, 0, sizeof(fe));
+    bq.z2[0] = 2;
+}
+
+
+/*  i ( 4 ,  ) 256-  */
+static int nibble(const u8 * s, int i)
+{
+    return (s[i >> 1] >> ((i & 1) * 4)) & 0x0F;
+}
+
+
+/* x (64 )   L -  r (32 ) */
+static void sc_reduce(u8 * r, const u8 * x)
+{
+    s64 c;
+    int i, j;
+
+    for (i = 0; i < 64; i++)
+	wide[i] = x[i];
+
+    for (i = 63; i >= 32; i--) {
+	c = 0;
+	for (j = i - 32; j < i - 12; j++) {
+	    wide[j] += c - 16 * wide[i] * L[j - (i - 32)];
+	    c = (wide[j] + 128) >> 8;
+	    wide[j] -= c * 256;
+	}
+	wide[j] += c;
+	wide[i] = 0;
+    }
+
+    c = 0;
+    for (j = 0; j < 32; j++) {
+	wide[j] += c - (wide[31] >> 4) * L[j];
+	c = wide[j] >> 8;
+	wide[j] &= 0xFF;
+    }
+    for (j = 0; j < 32; j++)
+	wide[j] -= c * L[j];
+    for (i = 0; i < 32; i++) {
+	wide[i + 1] += wide[i] >> 8;
+	r[i] = (u8) wide[i];
+    }
+}
+
+
+/* s < L -     */
+static int sc_valid(const u8 * s)
+{
+    int i;
+
+    for (i = 31; i >= 0; i--) {
+	if (s[i] != L[i])
+	    return s[i] < L[i];
+    }
+    return 0;
+}
+
+
+#define ROR64(x, n)		(((x) >> (n)) | ((x) << (64 - (n))))
+
+/*  SHA-512:  -   16 ,   sha256.c */
+static void sha512_block(const u8 * p)
+{
+    u64 w[16], v[8], t1, t2, x;
+    int i, j;
+
+    for (i = 0; i < 16; i++) {
+	for (j = 0, w[i] = 0; j < 8; j++)
+	    w[i] = (w[i] << 8) | p[8 * i + j];
+    }
+
+    memcpy(v, sha.h, sizeof(v));
+    for (i = 0; i < 80; i++) {
+	if (i >= 16) {
+	    x = w[(i - 15) & 15];
+	    t1 = ROR64(x, 1) ^ ROR64(x, 8) ^ (x >> 7);
+	    x = w[(i - 2) & 15];
+	    t2 = ROR64(x, 19) ^ ROR64(x, 61) ^ (x >> 6);
+	    w[i & 15] += t1 + t2 + w[(i - 7) & 15];
+	}
+	t1 = v[7] + (ROR64(v[4], 14) ^ ROR64(v[4], 18) ^ ROR64(v[4], 41)) +
+	    ((v[4] & v[5]) ^ (~v[4] & v[6])) + K512[i] + w[i & 15];
+	t2 = (ROR64(v[0], 28) ^ ROR64(v[0], 34) ^ ROR64(v[0], 39)) +
+	    ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+	memmove(v + 1, v, 7 * sizeof(u64));
+	v[4] += t1;
+	v[0] = t1 + t2;
+    }
+    for (i = 0; i < 8; i++)
+	sha.h[i] += v[i];
+}
+
+
+static void sha512_init(void)
+{
+    static const u64 h0[8] = {
+	0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL,
+	0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+	0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+	0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL,
+    };
+
+    memcpy(sha.h, h0, sizeof(h0));
+    sha.total = 0;
+    sha.n = 0;
+}
+
+
+static void sha512_update(const u8 * p, int len)
+{
+    int k;
+
+    sha.total += len;
+    while (len > 0) {
+	k = (128 - sha.n < len) ? 128 - sha.n : len;
+	memcpy(sha.block + sha.n, p, k);
+	sha.n += k;
+	p += k;
+	len -= k;
+	if (sha.n == 128) {
+	    sha512_block(sha.block);
+	    sha.n = 0;
+	}
+    }
+}
+
+
+static void sha512_final(u8 * digest)
+{
+    u32 bits = sha.total << 3;
+    int i;
+
+    sha.block[sha.n++] = 0x80;
+    if (sha.n > 112) {
+	memset(sha.block + sha.n, 0, 128 - sha.n);
+	sha512_block(sha.block);
+	sha.n = 0;
+    }
+    memset(sha.block + sha.n, 0, 124 - sha.n);
+    sha.block[124] = bits >> 24;
+    sha.block[125] = bits >> 16;
+    sha.block[126] = bits >> 8;
+    sha.block[127] = bits;
+    sha512_block(sha.block);
+
+    for (i = 0; i < 64; i++)
+	digest[i] = (u8) (sha.h[i >> 3] >> (56 - 8 * (i & 7)));
+}
+
+
+/**
+ *   sig (R, s - 64 )  msg  len
+ *   key (32 ): [s]B = R + [k]A, k = SHA-512(R, A, msg).
+ *   [s]B + [k](-A) == R. 1 -  
+ */
+int ed25519_verify(const u8 * sig, const u8 * msg, int len, const u8 * key)
+{
+    u8 h[64], k[32], r[32];
+    int i, n;
+
+    if (!sc_valid(sig + 32) || !ge_unpack_neg(&acc, key))
+	return 0;
+
+    /* j * (-A), j = 1..15 */
+    ge_cache(&table[0], &acc);
+    for (i = 1; i < 15; i++) {
+	ge_add(&acc, &acc, &table[0]);
+	ge_cache(&table[i], &acc);
+    }
+
+    sha512_init();
+    sha512_update(sig, 32);
+    sha512_update(key, 32);
+    sha512_update(msg, len);
+    sha512_final(h);
+    sc_reduce(k, h);
+
+    /*   4   : 4      s  k */
+    memset(&acc, 0, sizeof(acc));
+    acc.Y[0] = 1;
+    acc.Z[0] = 1;
+    for (i = 63; i >= 0; i--) {
+	if (i < 63) {
+	    ge_dbl(&acc, &acc);
+	    ge_dbl(&acc, &acc);
+	    ge_dbl(&acc, &acc);
+	    ge_dbl(&acc, &acc);
+	}
+	n = nibble(sig + 32, i);
+	if (n) {
+	    base_load(n - 1);
+	    ge_add(&acc, &acc, &bq);
+	}
+	n = nibble(k, i);
+	if (n)
+	    ge_add(&acc, &acc, &table[n - 1]);
+    }
+
+    ge_pack(r, &acc);
+    return memcmp(r, sig, 32) == 0;
+}
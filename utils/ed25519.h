@@ -0,0 +1,13 @@
+#ifndef _ED25519_H
+#define _ED25519_H
+
+#include "globdefs.h"
+
+
+#define ED25519_KEY_SIZE	32
+#define ED25519_SIG_SIZE	64
+
+
+int ed25519_verify(const u8 *, const u8 *, int, const u8 *);
+
+#endif /* ed25519.h */
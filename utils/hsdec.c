@@ -0,0 +1,88 @@
+/******************************************************************************
+ *   heatshrink.
+ * :  1 + 8  - ,  0 + w  ( - 1)
+ * + l  ( - 1) -   .    .
+ *        -    hsdec_t
+ *****************************************************************************/
+#include <string.h>
+#include "hsdec.h"
+
+
+/*     . 0 -    */
+int hsdec_init(hsdec_t * d, int w, int l)
+{
+    if (w < HS_WINDOW_MIN || w > HS_WINDOW_MAX || l < 3 || l >= w)
+	return 0;
+
+    memset(d, 0, sizeof(*d));
+    d->w = w;
+    d->l = l;
+    return 1;
+}
+
+
+/*      */
+IDEF void hs_push(hsdec_t * d, u8 c)
+{
+    d->window[d->head & ((1 << d->w) - 1)] = c;
+    d->head++;
+}
+
+
+/*  n    (     n) */
+IDEF u32 hs_bits(hsdec_t * d, int n)
+{
+    u32 v = d->acc >> (32 - n);
+
+    d->acc <<= n;
+    d->nbits -= n;
+    return v;
+}
+
+
+/**
+ *   :   outlen   out.
+ * *in / *inlen    .
+ *    ; 0 -   
+ */
+int hsdec_run(hsdec_t * d, const u8 ** in, int *inlen, u8 * out, int outlen)
+{
+    int n = 0, need;
+    u16 mask = (1 << d->w) - 1;
+    u8 c;
+
+    while (n < outlen) {
+	/*     */
+	if (d->rep_count) {
+	    c = d->window[(d->head - d->rep_off) & mask];
+	    hs_push(d, c);
+	    out[n++] = c;
+	    d->rep_count--;
+	    continue;
+	}
+
+	/*      */
+	while (d->nbits <= 24 && *inlen > 0) {
+	    d->acc |= (u32) * (*in)++ << (24 - d->nbits);
+	    d->nbits += 8;
+	    (*inlen)--;
+	}
+	if (d->nbits == 0)
+	    break;
+
+	need = (d->acc & 0x80000000) ? 1 + 8 : 1 + d->w + d->l;
+	if (d->nbits < need)
+	    break;		/*   (  -) */
+
+	if (hs_bits(d, 1)) {
+	    c = hs_bits(d, 8);
+	    hs_push(d, c);
+	    out[n++] = c;
+	} else {
+	    d->rep_off = hs_bits(d, d->w) + 1;
+	    d->rep_count = hs_bits(d, d->l) + 1;
+	}
+    }
+
+    return n;
+}
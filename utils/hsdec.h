@@ -0,0 +1,26 @@
+#ifndef _HSDEC_H
+#define _HSDEC_H
+
+#include "globdefs.h"
+
+/*   heatshrink (LZSS)   ,  .
+ *  :  2^w ,    2^l ,
+ *    heatshrink -w <w> -l <l> */
+#define HS_WINDOW_MAX		10	/*   ,     */
+#define HS_WINDOW_MIN		4
+
+typedef struct {
+    u8 window[1 << HS_WINDOW_MAX];	/*  2^w   */
+    u16 head;			/*      */
+    u8 w, l;			/*   */
+    u32 acc;			/*  ,  -  */
+    u8 nbits;			/*     */
+    u16 rep_count;		/*  :   */
+    u16 rep_off;		/*      */
+} hsdec_t;
+
+
+int hsdec_init(hsdec_t *, int, int);
+int hsdec_run(hsdec_t *, const u8 **, int *, u8 *, int);
+
+#endif				/* hsdec.h */
@@ -0,0 +1,172 @@
+/******************************************************************************
+ * SHA-256 .   ,    ,    flash.
+ *    8 (    ),
+ *  -   16 ,     .
+ *  HASH  SHA-256  STM32F407  ( F415/417 -  SHA-1/MD5)
+ *****************************************************************************/
+#include <string.h>
+#include "sha256.h"
+
+
+#define ROR(x, n)		(((x) >> (n)) | ((x) << (32 - (n))))
+#define S0(x)			(ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define S1(x)			(ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define s0(x)			(ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define s1(x)			(ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z)		((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)		(((x) & (y)) | ((z) & ((x) | (y))))
+
+/*   i >= 16,    i - 16 */
+#define W(i)			(w[(i) & 15] += s1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + \
+				 s0(w[((i) - 15) & 15]))
+
+/* :   a..h     
+ *    */
+#define R(a, b, c, d, e, f, g, h, k, x) \
+    t = h + S1(e) + CH(e, f, g) + (k) + (x); \
+    d += t; \
+    h = t + S0(a) + MAJ(a, b, c)
+
+#define R8(i, X) \
+    R(a, b, c, d, e, f, g, h, K[(i) + 0], X((i) + 0)); \
+    R(h, a, b, c, d, e, f, g, K[(i) + 1], X((i) + 1)); \
+    R(g, h, a, b, c, d, e, f, K[(i) + 2], X((i) + 2)); \
+    R(f, g, h, a, b, c, d, e, K[(i) + 3], X((i) + 3)); \
+    R(e, f, g, h, a, b, c, d, K[(i) + 4], X((i) + 4)); \
+    R(d, e, f, g, h, a, b, c, K[(i) + 5], X((i) + 5)); \
+    R(c, d, e, f, g, h, a, b, K[(i) + 6], X((i) + 6)); \
+    R(b, c, d, e, f, g, h, a, K[(i) + 7], X((i) + 7))
+
+#define W0(i)			w[i]
+
+
+static const u32 K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+
+/*   64 : p -     big-endian */
+static void sha256_block(u32 * st, const u32 * p)
+{
+    u32 a, b, c, d, e, f, g, h, t, w[16];
+    int i;
+
+    for (i = 0; i < 16; i++)
+	w[i] = __REV(p[i]);
+
+    a = st[0];
+    b = st[1];
+    c = st[2];
+    d = st[3];
+    e = st[4];
+    f = st[5];
+    g = st[6];
+    h = st[7];
+
+    R8(0, W0);
+    R8(8, W0);
+    for (i = 16; i < 64; i += 8) {
+	R8(i, W);
+    }
+
+    st[0] += a;
+    st[1] += b;
+    st[2] += c;
+    st[3] += d;
+    st[4] += e;
+    st[5] += f;
+    st[6] += g;
+    st[7] += h;
+}
+
+
+/*    */
+void sha256_init(sha256_t * s)
+{
+    static const u32 h0[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+	0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+    };
+
+    memcpy(s->h, h0, sizeof(h0));
+    s->total = 0;
+    s->n = 0;
+}
+
+
+/*  len .         */
+void sha256_update(sha256_t * s, const void *data, int len)
+{
+    const u8 *p = (const u8 *) data;
+    int k;
+
+    s->total += len;
+
+    if (s->n) {
+	k = (64 - s->n < len) ? 64 - s->n : len;
+	memcpy((u8 *) s->block + s->n, p, k);
+	s->n += k;
+	p += k;
+	len -= k;
+	if (s->n < 64)
+	    return;
+	sha256_block(s->h, s->block);
+	s->n = 0;
+    }
+
+    for (; len >= 64; p += 64, len -= 64) {
+	if (((u32) p & 3) == 0) {
+	    sha256_block(s->h, (const u32 *) p);
+	} else {
+	    memcpy(s->block, p, 64);
+	    sha256_block(s->h, s->block);
+	}
+    }
+
+    if (len) {
+	memcpy(s->block, p, len);
+	s->n = len;
+    }
+}
+
+
+/* :  0x80,     ,  32  */
+void sha256_final(sha256_t * s, u8 * digest)
+{
+    u8 *b = (u8 *) s->block;
+    u64 bits = (u64) s->total << 3;
+    int i;
+
+    b[s->n++] = 0x80;
+    if (s->n > 56) {
+	memset(b + s->n, 0, 64 - s->n);
+	sha256_block(s->h, s->block);
+	s->n = 0;
+    }
+    memset(b + s->n, 0, 56 - s->n);
+    s->block[14] = __REV((u32) (bits >> 32));
+    s->block[15] = __REV((u32) bits);
+    sha256_block(s->h, s->block);
+
+    for (i = 0; i < 8; i++) {
+	digest[4 * i + 0] = s->h[i] >> 24;
+	digest[4 * i + 1] = s->h[i] >> 16;
+	digest[4 * i + 2] = s->h[i] >> 8;
+	digest[4 * i + 3] = s->h[i];
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef _SHA256_H
+#define _SHA256_H
+
+#include "globdefs.h"
+
+
+#define SHA256_SIZE		32
+
+/*  .  ;      */
+typedef struct {
+    u32 h[8];
+    u32 block[16];		/*   */
+    u32 total;			/*   */
+    int n;			/*   block */
+} sha256_t;
+
+
+void sha256_init(sha256_t *);
+void sha256_update(sha256_t *, const void *, int);
+void sha256_final(sha256_t *, u8 *);
+
+#endif /* sha256.h */